@@ -52,28 +52,51 @@ v1.0-20160529: Created Console Layer Library
 ----------------------------------------------------------------------------------------------------
  Library Sizes
 --------------------------------------------------
-Compiled Size: (slightly smaller than this)
-  APLITE Total footprint in RAM:         1814 bytes / 24KB
-  BASALT Total footprint in RAM:         1814 bytes / 64KB
-  CHALK  Total footprint in RAM:         1814 bytes / 64KB
+Compiled Size: see Library code under Feature Profiles below
 --------------------------------------------------
-Running Size:
-  Create Console Layer (500 byte buffer) : 588 heap bytes used
+Running Size: (struct sizes worked out for 32-bit watches)
+  Create Console Layer (500 byte buffer) : the system's layer + 96 bytes of layer data (its own 64 byte log inside) + the 500 byte buffer
+  Create Console Log (500 byte buffer)   : 64 byte log struct + its buffer.  Layers created with a log have 32 bytes of layer data and no buffer
+  Reserving room for high priority text  : no extra heap, it's a slice of the log's buffer
+  Packing a log's text                   : no extra heap, text is unpacked into the rendering buffer as it's drawn
+  Exporting a log to the phone           : one batch (AppMessage outbox size, less 42 bytes) on the heap until it's done
+  Pinning a line                         : a child layer with 24 bytes of data + its text size.  Updating it redraws the log (2nd buffer below)
+  Built-in glyphs                        : no extra heap, they're drawn straight into the frame buffer
   Allocates 2nd buffer on the heap (same size as layer buffer, e.g. 500 bytes) temporarily when rendering
   Doesn't use too much stack when rendering or writing, maybe a couple dozen bytes?
+--------------------------------------------------
+Feature Profiles: (set console_layer_profile in console.h)
+  Buffer bytes used per text written, on top of the text and its terminating 0:
+    CONSOLE_PROFILE_FULL       : 1 settings byte + 1 (text color) + 1 (background color) + 4 (font) if not inherited
+                                 + 2 (extended settings and span count) + 2 per span with inline styles
+    CONSOLE_PROFILE_STYLED_LOG : 1 settings byte + 1 (text color) if not inherited
+                                 + 2 (extended settings and span count) + 2 per span with inline styles
+    CONSOLE_PROFILE_PLAIN_LOG  : 1 settings byte
+    Any profile                : + 1 length byte with console_layer_chunk_lengths
+  Library code (.text of console.c built with -Os for x86-64, for comparing profiles, not device numbers):
+    CONSOLE_PROFILE_FULL       : 11004 bytes
+    CONSOLE_PROFILE_STYLED_LOG : 10414 bytes  (no font, background, alignment or word wrap decoding, no row fills)
+    CONSOLE_PROFILE_PLAIN_LOG  :  7927 bytes  (no settings decoding at all, no inline style parsing)
+    console_layer_chunk_lengths: about 120 bytes more, in any profile
+    console_layer_phone_export : about 2860 bytes more, in any profile
+    console_layer_glyphs       : about 2350 bytes more, in any profile (485 of them the glyph atlas)
 
 ----------------------------------------------------------------------------------------------------
  Data Structure and Buffer Description
 --------------------------------------------------
-         | |      First Chunk      |     Second Chunk      |      Third Chunk      |
- Buffer: |0|SBCFONTstring...string0|SBCFONTstring...string0|SBCFONTstring...string0|0000000---til end of buffer
-          ^=BOF/EOF(pos points here)                      ^=0 terminated EndOfString (EOS)
+         | |      First Chunk       |     Second Chunk       |      Third Chunk       |
+ Buffer: |0|SBCFONTstring...string0L|SBCFONTstring...string0L|SBCFONTstring...string0L|0000000---til end of buffer
+          ^=BOF/EOF(pos points here)                       ^=0 terminated EndOfString (EOS)
           
        0 = 1 byte:  Circular Buffer Begin/End of file (BOF/EOF) split point (must = 0)
-  string = x bytes: The 0-termindated string displayed  (required, though can = 0 for empty string)
+       L = 1 byte:  Chunk Length, from S to L (optional, if console_layer_chunk_lengths; 0 = longer than 255 bytes)
+  string = x bytes: The 0-termindated string displayed  (required, though can = 0 for empty string; packed if the log is, see Packed Text)
+   SPANS = y bytes: Inline Style Span Table (optional, if bit a=1 in Extended Settings Byte)
+                    1 byte span count, then for each span: 1 byte length, 1 byte text color
     FONT = 4 bytes: Font Pointer          (optional, if bit b=1 in Settings Byte)
        C = 1 byte:  Text Color            (optional, if bit c=1 in Settings Byte)
        B = 1 byte:  Text Background Color (optional, if bit d=1 in Settings Byte)
+       X = 1 byte:  Extended Settings Byte (optional, if bits gh=11 in Settings Byte; sits between S and B)
        S = 1 byte:  Settings Byte
        0babcdefgh = Settings Byte
          a        1 bit:  Settings                    [Must = 1]
@@ -81,11 +104,14 @@ Running Size:
            c      1 bit:  Text Color Specified?       [0 = no (inherit from console_layer), 1 = yes]
             d     1 bit:  Font Specified?             [0 = no (inherit from console_layer), 1 = yes]
              ef   2 bits: Alignment                   [00=left, 01=center, 10=right,   11=inherit]
-               gh 2 bits: Word Wrap                   [00=no,   01=yes,    10=inherit, 11=inherit]
+               gh 2 bits: Word Wrap                   [00=no,   01=yes,    10=inherit, 11=extended]
                g  1 bit:  Inherit Word Wrap?          [0 = no (change), 1 = yes (inherit)]
-                h 1 bit:  bit g = 1: Unused. bit g = 0: Word Wrap? (0 = no, 1 = yes)
+                h 1 bit:  bit g = 1: Extended Settings Byte follows. bit g = 0: Word Wrap? (0 = no, 1 = yes)
                           "Word Wrap no" means one line of text displayed only (ends in "..." if too long)
                           "Word Wrap yes" means wrap long (and \n inside string) text to multiple lines
+       0ba00000gh = Extended Settings Byte
+         a        1 bit:  Span Table Specified?       [0 = no, 1 = yes]
+               gh 2 bits: Word Wrap                   [00=no,   01=yes,    10=inherit]
 
 
 --------------------------------------------------
@@ -97,12 +123,50 @@ Buffer: "ing0|SBCFON|0|SBCFONTstring...string0|SBCFONTstring...string0|SBCFONTst
                      ^ = BOF/EOF
 
 In this example, the Fourth Chunk is invalid since it's been partially overwritten by the First Chunk (First = Most recently written, bottom of the text)
+Each buffer keeps where its oldest valid chunk starts (the Third here), and reading stops there (see Valid Chunks).
+
+
+--------------------------------------------------
+ High Priority Text
+--------------------------------------------------
+If part of the buffer is reserved for high priority text, the end of the buffer is split off as a second circular buffer
+laid out exactly the same way, except every chunk has 4 more bytes right after its Settings Byte:
+
+ Buffer: |0|S..string0L|S..string0L|0000---|0|STTTTBCFONTstring...string0L|STTTTBCFONTstring...string0L|000---til end of buffer
+          ^=normal text BOF/EOF           ^=high priority BOF/EOF
+
+    TTTT = 4 bytes: Stamp (lowest byte first): how many normal chunks had been written when this one was written.
+           It's 32 bits so it doesn't wrap around while the chunk could still be in the buffer.
+
+Normal text can't overwrite high priority text (and vice versa), so errors outlast a flood of chatter.
+When rendering, both buffers are walked at once from newest to oldest: a high priority chunk is drawn as soon as
+the normal chunks newer than it have been drawn, so the two are merged in the order they were written.
 
 ----------------------------------------------------------------------------------------------------
 */
 
 #include "console.h"
 
+// A circular buffer of chunks (see Data Structure and Buffer Description above)
+typedef struct console_ring {
+  size_t         buffer_size;
+  uintptr_t      pos;
+  char          *buffer;
+  uintptr_t      oldest;          // Start of the oldest chunk that hasn't been written over, counted from pos (0 = none)
+  size_t         used;            // End of that chunk (its last byte), counted from pos
+  bool           stale;           // Whether oldest has to be found again before it's read (see Valid Chunks below)
+} console_ring;
+
+struct ConsoleLog {
+  console_ring   ring;            // Normal text
+  console_ring   priority;        // High priority text, in a slice reserved at the end of the buffer (buffer_size 0 = none)
+  uint32_t       stamp;           // Chunks written to ring so far (wraps around).  Priority chunks save it to be put in order.
+  uint32_t       priority_count;  // Chunks written to priority so far (wraps around)
+  bool           packed;          // Whether text is stored packed (see Packed Text below)
+  bool           owned;           // Whether it's inside the data of the layer it was created with (destroyed with it)
+  Layer         *layers;          // First console layer showing this log (NULL = none)
+};
+
 typedef struct console_data_struct {
   bool           word_wrap;
   GColor         background_color;
@@ -110,29 +174,374 @@ typedef struct console_data_struct {
   GFont          font;
   GTextAlignment alignment;
 
-  size_t         buffer_size;
-  uintptr_t      pos;
-  char          *buffer;
+  ConsoleLog    *log;             // Log the layer is showing (NULL = none)
+  Layer         *next_layer;      // Next console layer showing the same log
+  Layer         *pinned;          // First line pinned to the layer (NULL = none)
+  int16_t        pinned_top;      // Height of the slots of lines pinned to the top, and to the bottom
+  int16_t        pinned_bottom;
+  bool           owns_log;        // Whether own_log (and its buffer) was allocated with the layer
+  ConsoleLog     own_log;         // Log created with the layer.  Must be last inside struct: its buffer follows it.
 } console_data_struct;
+
+// A pinned line's layer data (see Pinned Lines below)
+typedef struct console_pinned_struct {
+  Layer         *console_layer;   // Layer the line is pinned to
+  Layer         *next_pinned;     // Next line pinned to the same layer
+  ConsolePinPosition position;
+  GFont          font;            // The console layer's font when it was pinned, which its slot is sized for
+  size_t         size;            // Room for text, including its terminating 0
+  char          *text;            // Points just after the struct
+} console_pinned_struct;
                                           // 0bABCDEFGH = Settings Byte
 #define          SETTINGS_BIT  0b10000000 //   A        1 bit:  Always = 1 (Makes sure settings byte isn't 0, which would signify EOF)
 #define  BACKGROUND_COLOR_BIT  0b01000000 //    B       1 bit:  Background Color Specified? [0 = no (inherit from console_layer), 1 = yes]
 #define        TEXT_COLOR_BIT  0b00100000 //     C      1 bit:  Text Color Specified?       [0 = no (inherit from console_layer), 1 = yes]
 #define              FONT_BIT  0b00010000 //      D     1 bit:  Font Specified?             [0 = no (inherit from console_layer), 1 = yes]
 #define         ALIGNMENT_BITS 0b00001100 //       EF   2 bits: Alignment                   [00=left, 01=center, 10=right,   11=inherit]
-#define         WORD_WRAP_BITS 0b00000011 //         GH 2 bits: Word Wrap                   [00=no,   01=yes,    10=inherit, 11=inherit]
+#define         WORD_WRAP_BITS 0b00000011 //         GH 2 bits: Word Wrap                   [00=no,   01=yes,    10=inherit, 11=extended]
 #define WORD_WRAP_INHERIT_BIT  0b00000010 //         G  1 bit:  Inherit Word Wrap?          [0 = no (change), 1 = yes (inherit)]
-#define         WORD_WRAP_BIT  0b00000001 //          H 1 bit:  WORD_WRAP_INHERIT_BIT = 1: Unused. WORD_WRAP_INHERIT_BIT = 0: Word Wrap
+#define         WORD_WRAP_BIT  0b00000001 //          H 1 bit:  WORD_WRAP_INHERIT_BIT = 1: Extended. WORD_WRAP_INHERIT_BIT = 0: Word Wrap
+#define          EXTENDED_BITS 0b00000011 //         GH 2 bits: = 11: Extended Settings Byte follows, holding the real Word Wrap bits
 // Word Wrap: 0 = One line of text displayed only (ends in "..." if too long), 1 = Wrap Long (and \n) Text to multiple lines
-
-#define DEFAULT_BUFFER_SIZE 500      // Size (in bytes) of text buffer -- per layer
+                                          // 0bA00000GH = Extended Settings Byte
+#define             SPANS_BIT  0b10000000 //   A        1 bit:  Span Table Specified?       [0 = no, 1 = yes]
+                                          //         GH 2 bits: Word Wrap                   [00=no,   01=yes,    10=inherit]
+
+#define ESCAPE_CHARACTER '\x1b'        // Begins an inline style escape sequence, e.g. "\x1b[31m"
+#define MAX_SPANS         16            // Most inline style spans a single chunk can have
+
+typedef struct console_span {
+  uint8_t        length;                // Length of the span's text in bytes (the last span runs to the end of the string)
+  GColor         color;                 // Text color of the span (GColorInherit to use the chunk's text color)
+} console_span;
+
+// Settings bytes which start a chunk, in the order they're read: Settings, [Stamp], Extended, Background, Text Color, Font
+typedef struct console_header {
+  uint8_t        length;
+  uint8_t        bytes[8 + sizeof(GFont)];
+} console_header;
+
+// A chunk about to be written: where its text comes from, and what it'll take up in the buffer
+typedef struct console_chunk {
+  const char    *text;                  // Text as given (may contain inline style escape sequences)
+  const char    *end;                   // End of the text (0 or \n)
+  bool           escapes;               // Whether text contains escape sequences
+  size_t         length;                // Length of the text to write, without escape sequences
+  bool           truncated;             // Whether the text was too big for the buffer and has been cut short
+  bool           packed;                // Whether the text is packed
+  size_t         plain_from;            // Text from here on is written as it is (after 15, 0 if packed)
+  size_t         stored;                // Bytes the text takes up in the buffer
+  const console_header *header;
+  uint8_t        span_count;
+  console_span   spans[MAX_SPANS];
+} console_chunk;
+
+// Lines to write as separate chunks: from an array of strings, or from one string split at each \n
+typedef struct console_lines {
+  const char   **array;                 // Next string in the array (NULL when splitting text)
+  const char    *text;                  // Start of the next line when splitting text (NULL = no more lines)
+  size_t         count;                 // Strings left in the array
+} console_lines;
+
+#define DEFAULT_BUFFER_SIZE 500      // Size (in bytes) of text buffer -- per layer or log
+
+// Features included by console_layer_profile (see console.h)
+#define CHUNK_STYLES (console_layer_profile == CONSOLE_PROFILE_FULL)       // Per-text fonts, background colors, alignment and word wrap
+#define CHUNK_COLORS (console_layer_profile != CONSOLE_PROFILE_PLAIN_LOG)  // Per-text text colors and inline styles
+#define CHUNK_LENGTH (console_layer_chunk_lengths ? 1 : 0)                 // Length byte after each chunk's EndOfString
 
 #if (dirty_console_layer_automatically)
   #define MARK_DIRTY layer_mark_dirty(console_layer)
+  #define MARK_LOG_DIRTY console_log_mark_dirty(console_log)
 #else
   #define MARK_DIRTY
+  #define MARK_LOG_DIRTY
+#endif
+
+#if (console_layer_trace)
+  #define TRACE(record) record
+#else
+  #define TRACE(record)
 #endif
 
+#define TRACE_BUFFER_SIZE 1024       // Size (in bytes) of the trace buffer -- shared by all layers
+#define TRACE_MAX_OBJECTS  16        // Layers, logs and pinned lines after this many share id 255
+#define TRACE_MAX_FONTS    15        // Fonts after this many share font id 255
+
+
+//------------------------------------------------------------------------------------------------//
+// Trace
+//----------------------------------------------//
+#if (console_layer_trace)
+static struct {
+  uint8_t  data[TRACE_BUFFER_SIZE];
+  uint16_t length;
+  uint32_t last_ms;                  // Time of the last record (0 = no records yet)
+  void    *objects[TRACE_MAX_OBJECTS]; // Layers, logs and pinned lines, by id
+  GFont    fonts[TRACE_MAX_FONTS];
+} trace;
+
+void console_trace_dump(void) {
+  static const char hex[] = "0123456789abcdef";
+  char line[2 * 32 + 1];
+  for (uint16_t i = 0; i < trace.length; i += 32) {
+    uint16_t n = 0;
+    for (uint16_t j = i; j < trace.length && j < i + 32; j++) {
+      line[n++] = hex[trace.data[j] >> 4];
+      line[n++] = hex[trace.data[j] & 0x0F];
+    }
+    line[n] = 0;
+    APP_LOG(APP_LOG_LEVEL_INFO, "CONSOLE_TRACE %s", line);
+  }
+  trace.length = 0;
+}
+
+static uint8_t trace_id(void *object) {
+  for (uint8_t i = 0; i < TRACE_MAX_OBJECTS; i++)
+    if (object && trace.objects[i] == object) return i;
+  return 255;
+}
+
+// Gives a new layer, log or pinned line the first free id
+static void trace_add_object(void *object) {
+  for (uint8_t i = 0; i < TRACE_MAX_OBJECTS; i++)
+    if (!trace.objects[i]) {trace.objects[i] = object; return;}
+}
+
+static void trace_u8(uint8_t value) {
+  trace.data[trace.length++] = value;
+}
+
+static void trace_u16(uint16_t value) {
+  trace_u8(value & 0xFF);
+  trace_u8(value >> 8);
+}
+
+static uint32_t trace_now(void) {
+  time_t seconds;
+  uint16_t milliseconds;
+  time_ms(&seconds, &milliseconds);
+  return (uint32_t)seconds * 1000 + milliseconds;
+}
+
+// Starts a record with room for arguments_size bytes of arguments, dumping the trace first if it's full
+static void trace_record(ConsoleTraceType type, void *object, uint16_t arguments_size) {
+  if (trace.length + 4 + arguments_size > TRACE_BUFFER_SIZE)
+    console_trace_dump();
+
+  uint32_t now = trace_now();
+  uint32_t elapsed = trace.last_ms ? now - trace.last_ms : 0;
+  trace.last_ms = now;
+
+  trace_u8(type);
+  trace_u16(elapsed > UINT16_MAX ? UINT16_MAX : elapsed);
+  trace_u8(trace_id(object));
+}
+
+// Records a new font's line height and average character width, so replay can stand in a font of the same size
+static void trace_font(GFont font, uint8_t font_id) {
+  GRect box = GRect(0, 0, 0x7FFF, 0x7FFF);
+  GSize line = graphics_text_layout_get_content_size("abcdefghijklmnopqrstuvwxyz", font, box, GTextOverflowModeTrailingEllipsis, GTextAlignmentLeft);
+  trace_record(ConsoleTraceFont, NULL, 3);
+  trace_u8(font_id);
+  trace_u8(line.h > UINT8_MAX ? UINT8_MAX : line.h);
+  trace_u8((line.w + 13) / 26);
+}
+
+// Font id for a font.  Call it before starting the record it goes in: a new font gets a Font record first.
+static uint8_t trace_font_id(GFont font) {
+  if (!font) return 0;
+  #if (console_layer_glyphs)
+  if (font == GFontConsoleGlyphs) return 254;
+  #endif
+  for (uint8_t i = 0; i < TRACE_MAX_FONTS; i++) {
+    if (trace.fonts[i] == font) return i + 1;
+    if (!trace.fonts[i]) {
+      trace.fonts[i] = font;  // First time this font has been seen
+      trace_font(font, i + 1);
+      return i + 1;
+    }
+  }
+  return 255;
+}
+
+static void trace_create(Layer *console_layer, GRect frame, int buffer_size, ConsoleLog *console_log) {
+  trace_add_object(console_layer);
+  if (buffer_size) trace_add_object(console_log);  // Its own log
+  trace_record(ConsoleTraceCreate, console_layer, 11);
+  trace_u16(buffer_size);
+  trace_u16(frame.origin.x);
+  trace_u16(frame.origin.y);
+  trace_u16(frame.size.w);
+  trace_u16(frame.size.h);
+  trace_u8(trace_id(console_log));
+}
+
+static void trace_create_log(ConsoleLog *console_log, int buffer_size) {
+  trace_add_object(console_log);
+  trace_record(ConsoleTraceCreateLog, console_log, 2);
+  trace_u16(buffer_size);
+}
+
+static void trace_add_pinned(Layer *pinned_line, Layer *console_layer, ConsolePinPosition position, int size) {
+  trace_add_object(pinned_line);
+  trace_record(ConsoleTraceAddPinned, pinned_line, 4);
+  trace_u8(trace_id(console_layer));
+  trace_u8(position);
+  trace_u16(size);
+}
+
+// Ends a redraw which started at start (from trace_now()) and drew rows rows
+static void trace_redraw(Layer *layer, uint32_t start, uint8_t rows) {
+  uint32_t elapsed = trace_now() - start;
+  trace_record(ConsoleTraceRedraw, layer, 3);
+  trace_u16(elapsed > UINT16_MAX ? UINT16_MAX : elapsed);
+  trace_u8(rows);
+}
+
+static void trace_destroy(void *object) {
+  trace_record(ConsoleTraceDestroy, object, 0);
+  uint8_t id = trace_id(object);
+  if (id < TRACE_MAX_OBJECTS) trace.objects[id] = NULL;
+}
+
+static void trace_byte(ConsoleTraceType type, void *object, uint8_t value) {
+  trace_record(type, object, 1);
+  trace_u8(value);
+}
+
+static void trace_style(ConsoleTraceType type, void *object, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
+  uint8_t font_id = trace_font_id(font);
+  trace_record(type, object, type == ConsoleTraceSetStyle ? 5 : type == ConsoleTraceWriteLines ? 9 : 7);
+  trace_u8(text_color.argb);
+  trace_u8(background_color.argb);
+  trace_u8(font_id);
+  trace_u8(alignment);
+  trace_u8(word_wrap);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------//
+// Logs
+//----------------------------------------------//
+#if (dirty_console_layer_automatically)
+static void console_log_mark_dirty(ConsoleLog *console_log) {
+  for (Layer *layer = console_log->layers; layer; layer = ((console_data_struct*)layer_get_data(layer))->next_layer)
+    layer_mark_dirty(layer);
+}
+#endif
+
+// Removes a layer from its log's list of layers showing it
+static void console_log_remove_layer(ConsoleLog *console_log, Layer *console_layer) {
+  for (Layer **layer = &console_log->layers; *layer; layer = &((console_data_struct*)layer_get_data(*layer))->next_layer)
+    if (*layer == console_layer) {
+      *layer = ((console_data_struct*)layer_get_data(console_layer))->next_layer;
+      return;
+    }
+}
+
+// Detaches every layer showing the log, so none are left pointing to it
+static void console_log_remove_all_layers(ConsoleLog *console_log) {
+  while (console_log->layers) {
+    Layer *console_layer = console_log->layers;
+    console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
+    console_log->layers = console_data->next_layer;
+    console_data->log = NULL;
+    console_data->next_layer = NULL;
+    MARK_DIRTY;
+  }
+}
+
+static void console_log_init(ConsoleLog *console_log, char *buffer, int buffer_size) {
+  console_log->ring = (console_ring){.buffer = buffer, .buffer_size = buffer_size};
+  console_log->priority = (console_ring){.buffer = buffer + buffer_size, .buffer_size = 0};
+  console_log->layers = NULL;
+  console_log->packed = false;
+  console_log->owned = false;
+  console_log->stamp = 0;
+  console_log->priority_count = 0;
+  console_log_clear(console_log);
+}
+
+//----------------------------------------------//
+
+ConsoleLog* console_log_create(int buffer_size) {
+  ConsoleLog *console_log = malloc(sizeof(ConsoleLog) + buffer_size);
+  if (console_log) {
+    TRACE(trace_create_log(console_log, buffer_size));
+    console_log_init(console_log, (char*)(console_log + 1), buffer_size);  // Buffer is allocated just after the struct
+  }
+  return console_log;
+}
+
+#if (console_layer_phone_export)
+static void console_export_stop(ConsoleLog *console_log);  // See Export below
+#endif
+
+void console_log_destroy(ConsoleLog *console_log) {
+  if (console_log->owned) {
+    // Not allocated by itself (it came from console_layer_get_log): It goes with its layer
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Not destroying a console layer's own log: Destroy the layer instead");
+    return;
+  }
+  TRACE(trace_destroy(console_log));
+  #if (console_layer_phone_export)
+  console_export_stop(console_log);
+  #endif
+  console_log_remove_all_layers(console_log);
+  free(console_log);
+}
+
+//----------------------------------------------//
+
+void console_log_reserve_priority(ConsoleLog *console_log, int reserve_size) {
+  // Both rings need room for at least an EOF 0 and an empty chunk's 0
+  size_t total_size = console_log->ring.buffer_size + console_log->priority.buffer_size;
+  size_t size = reserve_size < 2 ? 0 : (size_t)reserve_size + 2 > total_size ? total_size - 2 : (size_t)reserve_size;
+  TRACE(trace_record(ConsoleTraceReservePriority, console_log, 2));
+  TRACE(trace_u16(reserve_size));
+  console_log->ring.buffer_size = total_size - size;
+  console_log->priority = (console_ring){.buffer = console_log->ring.buffer + console_log->ring.buffer_size, .buffer_size = size};
+  console_log_clear(console_log);
+}
+
+void console_layer_reserve_priority(Layer *console_layer, int reserve_size) {
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  if (console_log) console_log_reserve_priority(console_log, reserve_size);
+}
+
+void console_log_set_packed(ConsoleLog *console_log, bool packed) {
+  TRACE(trace_byte(ConsoleTraceSetPacked, console_log, packed));
+  console_log->packed = packed;
+  console_log_clear(console_log);  // Text already written can't be read the other way
+}
+
+void console_layer_set_packed(Layer *console_layer, bool packed) {
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  if (console_log) console_log_set_packed(console_log, packed);
+}
+
+//----------------------------------------------//
+
+ConsoleLog* console_layer_get_log(Layer *console_layer) {
+  return ((console_data_struct*)layer_get_data(console_layer))->log;
+}
+
+void console_layer_set_log(Layer *console_layer, ConsoleLog *console_log) {
+  console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
+  if (console_data->log)
+    console_log_remove_layer(console_data->log, console_layer);
+  console_data->log = console_log;
+  console_data->next_layer = NULL;
+  if (console_log) {
+    console_data->next_layer = console_log->layers;
+    console_log->layers = console_layer;
+  }
+  MARK_DIRTY;
+  TRACE(trace_byte(ConsoleTraceSetLog, console_layer, trace_id(console_log)));
+}
+
+
 //------------------------------------------------------------------------------------------------//
 // Gets
 //----------------------------------------------//
@@ -147,12 +556,17 @@ GFont          console_layer_get_font            (Layer *console_layer) {return
 //------------------------------------------------------------------------------------------------//
 // Sets
 //----------------------------------------------//
+// The layer's alignment is what text inheriting alignment uses, so it can't be Inherit.  Defaults to Left if it is.
+static GTextAlignment console_valid_alignment(GTextAlignment alignment) {
+  return (alignment==GTextAlignmentLeft || alignment==GTextAlignmentCenter || alignment==GTextAlignmentRight) ? alignment : GTextAlignmentLeft;
+}
 
-void console_layer_set_background_color(Layer *console_layer, GColor         background_color){((console_data_struct*)layer_get_data(console_layer))->background_color = background_color; MARK_DIRTY;}
-void console_layer_set_alignment       (Layer *console_layer, GTextAlignment alignment)       {((console_data_struct*)layer_get_data(console_layer))->alignment        = alignment;        MARK_DIRTY;}
-void console_layer_set_text_color      (Layer *console_layer, GColor         text_color)      {((console_data_struct*)layer_get_data(console_layer))->text_color       = text_color;       MARK_DIRTY;}
-void console_layer_set_word_wrap       (Layer *console_layer, bool           word_wrap)       {((console_data_struct*)layer_get_data(console_layer))->word_wrap        = word_wrap;        MARK_DIRTY;}
-void console_layer_set_font            (Layer *console_layer, GFont          font)            {((console_data_struct*)layer_get_data(console_layer))->font             = font;             MARK_DIRTY;}
+
+void console_layer_set_background_color(Layer *console_layer, GColor         background_color){((console_data_struct*)layer_get_data(console_layer))->background_color = background_color; MARK_DIRTY; TRACE(trace_byte(ConsoleTraceSetBackgroundColor, console_layer, background_color.argb));}
+void console_layer_set_alignment       (Layer *console_layer, GTextAlignment alignment)       {((console_data_struct*)layer_get_data(console_layer))->alignment        = console_valid_alignment(alignment); MARK_DIRTY; TRACE(trace_byte(ConsoleTraceSetAlignment, console_layer, alignment));}
+void console_layer_set_text_color      (Layer *console_layer, GColor         text_color)      {((console_data_struct*)layer_get_data(console_layer))->text_color       = text_color;       MARK_DIRTY; TRACE(trace_byte(ConsoleTraceSetTextColor, console_layer, text_color.argb));}
+void console_layer_set_word_wrap       (Layer *console_layer, bool           word_wrap)       {((console_data_struct*)layer_get_data(console_layer))->word_wrap        = word_wrap;        MARK_DIRTY; TRACE(trace_byte(ConsoleTraceSetWordWrap, console_layer, word_wrap));}
+void console_layer_set_font            (Layer *console_layer, GFont          font)            {((console_data_struct*)layer_get_data(console_layer))->font             = font;             MARK_DIRTY; TRACE(trace_byte(ConsoleTraceSetFont, console_layer, trace_font_id(font)));}
 
 
 //----------------------------------------------//
@@ -163,8 +577,9 @@ void console_layer_set_style(Layer *console_layer, GColor text_color, GColor bac
   console_data->background_color = background_color;
   console_data->font             = font;
   console_data->word_wrap        = word_wrap;
-  console_data->alignment        = alignment;
+  console_data->alignment        = console_valid_alignment(alignment);
   MARK_DIRTY;
+  TRACE(trace_style(ConsoleTraceSetStyle, console_layer, text_color, background_color, font, alignment, word_wrap));
 }
 
 //------------------------------------------------------------------------------------------------//
@@ -175,90 +590,889 @@ void console_layer_set_style(Layer *console_layer, GColor text_color, GColor bac
 
 
 //------------------------------------------------------------------------------------------------//
-// Write Layer
+// Inline Styles
 //----------------------------------------------//
+#if CHUNK_COLORS
+// Text colors for ANSI SGR codes 30-37 (normal) and 90-97 (bright)
+static GColor console_ansi_color(int code) {
+  switch (code) {
+    case 30: return GColorBlack;        case 90: return GColorDarkGray;
+    case 31: return GColorRed;          case 91: return GColorSunsetOrange;
+    case 32: return GColorGreen;        case 92: return GColorScreaminGreen;
+    case 33: return GColorYellow;       case 93: return GColorIcterine;
+    case 34: return GColorBlue;         case 94: return GColorVeryLightBlue;
+    case 35: return GColorMagenta;      case 95: return GColorShockingPink;
+    case 36: return GColorCyan;         case 96: return GColorElectricBlue;
+    case 37: return GColorLightGray;    case 97: return GColorWhite;
+    default: return GColorInherit;      // 0 = Reset, 39 = Default
+  }
+}
 
-void console_layer_clear(Layer *console_layer) {
-  console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
-  console_data->pos = 0;
-  console_data->buffer[0] = 0;
-  console_data->buffer[1] = 0;
-  MARK_DIRTY;
+// Reads the escape sequence that text points to, returning a pointer to just after it (or end).
+// Only SGR color sequences ("\x1b[31m") change the color.  Anything else is skipped.
+static const char* console_read_escape(const char *text, const char *end, GColor *color) {
+  if (++text == end || *text != '[') return text;  // Lone ESC: drop it, keep the next character
+  int code = 0;
+  while (++text < end) {
+    if (*text >= '0' && *text <= '9') {
+      if (code < 1000) code = code * 10 + (*text - '0');
+    } else if (*text == ';' || *text == 'm') {
+      if (code == 0 || code == 39 || (code >= 30 && code <= 37) || (code >= 90 && code <= 97))
+        *color = console_ansi_color(code);
+      code = 0;
+      if (*text == 'm') return text + 1;
+    } else {
+      return text + 1;  // Unsupported sequence: drop it
+    }
+  }
+  return text;  // String ended mid-sequence
+}
+
+// Splits text into spans of the same color, returning the length of the text without its escape sequences
+static size_t console_parse_spans(const char *text, const char *end, console_span *spans, uint8_t *span_count) {
+  GColor color = GColorInherit;
+  size_t length = 0;
+  uint8_t count = 0;
+  while (text < end) {
+    if (*text == ESCAPE_CHARACTER) {
+      text = console_read_escape(text, end, &color);
+      continue;
+    }
+    if (count == 0 || (count < MAX_SPANS && (spans[count-1].color.argb != color.argb || spans[count-1].length == UINT8_MAX))) {
+      if (count > 0 && spans[count-1].length == 0)
+        count--;  // Color changed before any text was written with the old color, so reuse the empty span
+      spans[count++] = (console_span){.length = 0, .color = color};
+    }
+    if (spans[count-1].length < UINT8_MAX) spans[count-1].length++;  // The last span runs to the end, so can stop counting
+    length++;
+    text++;
+  }
+  *span_count = count;
+  return length;
 }
+#endif
 
+
+
+
+//------------------------------------------------------------------------------------------------//
+// Packed Text
 //----------------------------------------------//
+// Text in a packed log is stored a nibble (4 bits) at a time, high nibble first:
+//   1 to 11:     The 11 most common characters
+//   12 to 14, x: The next 48 most common characters
+//   15, h, l:    Any other byte, as it is (h is never 0)
+//   15, 0:       The rest of the text is stored as it is, starting at the next whole byte
+// Every code starts with a nonzero nibble and no byte of text is 0, so a packed byte is never 0 and chunks still end at 0.
+// An odd nibble out at the end is padded with 15 (a byte cut short, which is ignored).
+static const char PACKED_CHARACTERS[] = " etaoinsrdl" "cuhmpgfywbvkx0123456789:.!=-,%()/'\nSCREDTPBAHOLW";
+#define PACKED_SINGLES 11  // Characters with 1 nibble codes
+#define PACKED_RAW     15  // Nibble before a byte stored as it is
+
+typedef struct console_packer {
+  console_ring  *ring;
+  uintptr_t      at;                    // Where the next byte goes
+  uint8_t        high;                  // High nibble waiting for a low nibble
+  bool           half;                  // Whether high is waiting
+} console_packer;
+
+// Nibbles a character takes up packed (0 = can't be packed: control characters other than \n)
+static uint8_t console_packed_nibbles(char c) {
+  const char *found = strchr(PACKED_CHARACTERS, c);
+  return found ? (found - PACKED_CHARACTERS < PACKED_SINGLES ? 1 : 2) : (uint8_t)c >= 0x10 ? 3 : 0;
+}
 
-void console_layer_write_text_styled(Layer *console_layer, char *text, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
-  console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
+static void console_pack_nibble(console_packer *packer, uint8_t nibble) {
+  if (packer->half)
+    packer->ring->buffer[packer->at++ % packer->ring->buffer_size] = packer->high << 4 | nibble;
+  else
+    packer->high = nibble;
+  packer->half = !packer->half;
+}
+
+static void console_pack_char(console_packer *packer, char c) {
+  const char *found = strchr(PACKED_CHARACTERS, c);
+  if (!found) {
+    console_pack_nibble(packer, PACKED_RAW);
+    console_pack_nibble(packer, (uint8_t)c >> 4);
+    console_pack_nibble(packer, c & 0x0F);
+  } else if (found - PACKED_CHARACTERS < PACKED_SINGLES) {
+    console_pack_nibble(packer, 1 + (found - PACKED_CHARACTERS));
+  } else {
+    uint8_t index = found - PACKED_CHARACTERS - PACKED_SINGLES;
+    console_pack_nibble(packer, PACKED_SINGLES + 1 + index / 16);
+    console_pack_nibble(packer, index % 16);
+  }
+}
+
+// Ends the packed text with 15, 0 (and padding) so the rest is written as it is
+static void console_pack_plain(console_packer *packer) {
+  console_pack_nibble(packer, PACKED_RAW);
+  console_pack_nibble(packer, 0);
+  if (packer->half) console_pack_nibble(packer, PACKED_RAW);
+}
+
+// Reads a string out of the buffer a character at a time, unpacking it if it's packed
+typedef struct console_reader {
+  const console_ring *ring;
+  intptr_t       cursor;                // Last byte read (on the EndOfString once it's been read)
+  bool           packed;                // Whether the rest of the string is packed
+  bool           low;                   // Whether the low nibble of the byte at cursor is next
+} console_reader;
+
+// Next nibble of a packed string (16 = none left: the next byte is the EndOfString)
+static uint8_t console_read_nibble(console_reader *reader) {
+  if (reader->low) {
+    reader->low = false;
+    return reader->ring->buffer[reader->cursor % reader->ring->buffer_size] & 0x0F;
+  }
+  uint8_t byte = reader->ring->buffer[(reader->cursor + 1) % reader->ring->buffer_size];
+  if (!byte) return 16;
+  reader->cursor++;
+  reader->low = true;
+  return byte >> 4;
+}
+
+// Next character of the string (0 = the EndOfString, which cursor is then on)
+static char console_read_char(console_reader *reader) {
+  const console_ring *ring = reader->ring;
+  uint8_t code, x, h, l;
+  if (reader->packed) {
+    while ((code = console_read_nibble(reader)) < 16) {
+      if (!code) continue;  // Never written, so it's text that's been written over (and won't be drawn)
+      if (code <= PACKED_SINGLES)
+        return PACKED_CHARACTERS[code - 1];
+      if (code < PACKED_RAW) {
+        if ((x = console_read_nibble(reader)) >= 16) break;
+        return PACKED_CHARACTERS[PACKED_SINGLES + (code - PACKED_SINGLES - 1) * 16 + x];
+      }
+      if ((h = console_read_nibble(reader)) >= 16) break;
+      if (h == 0) {
+        reader->packed = false;  // The rest is stored as it is
+        break;
+      }
+      if ((l = console_read_nibble(reader)) >= 16) break;
+      return h << 4 | l;
+    }
+  }
+  return ring->buffer[++reader->cursor % ring->buffer_size];
+}
+
+
+
+
+//------------------------------------------------------------------------------------------------//
+// Write Log
+//----------------------------------------------//
+
+static void console_ring_clear(console_ring *ring) {
+  ring->pos = 0;
+  ring->buffer[0] = 0;
+  ring->buffer[1] = 0;
+  ring->oldest = ring->used = 0;
+  ring->stale = false;
+}
 
-  console_data->pos += ((UINTPTR_MAX - (UINTPTR_MAX % console_data->buffer_size)) - console_data->buffer_size);
+void console_log_clear(ConsoleLog *console_log) {
+  console_ring_clear(&console_log->ring);
+  if (console_log->priority.buffer_size)
+    console_ring_clear(&console_log->priority);
+  MARK_LOG_DIRTY;
+  TRACE(trace_record(ConsoleTraceClear, console_log, 0));
+}
+
+//----------------------------------------------//
 
+// Builds the settings bytes for a chunk with the given style (and a span table, if spans)
+static void console_build_header(console_header *header, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap, bool spans) {
   uint8_t settings = SETTINGS_BIT;
-  
-  // Copy text (forwards in memory, but from last char to first char) to buffer
-  char *begin = text;
-  while(*text) text++;   // ends on 0
-  do {
-    console_data->buffer[console_data->pos-- % console_data->buffer_size] = *text;
-  } while((text--)!=begin);
-    
-
-  // Assemble settings
-  // Settings: If a Font is specified, copy to Buffer and flag it in Settings
-  if (font) {
-    for (uintptr_t i=0; i<sizeof(font); i++)
-      console_data->buffer[console_data->pos-- % console_data->buffer_size] = ((uint8_t*)&font)[i];
-    settings |= FONT_BIT;
+  header->length = 1;  // Settings go first, once they're assembled
+
+  // Settings: Flag Word Wrap in Settings, even it if it's "inherit from console_layer"
+  // If there are Extended Settings, Word Wrap moves into them and Settings flags that they follow
+  #if CHUNK_STYLES
+  uint8_t word_wrap_bits = word_wrap==WordWrapFalse ? 0b00 : word_wrap==WordWrapTrue ? 0b01 : WORD_WRAP_INHERIT_BIT;
+  #else
+  (void)font; (void)background_color; (void)alignment; (void)word_wrap;
+  uint8_t word_wrap_bits = WORD_WRAP_INHERIT_BIT;  // Profile doesn't support it: Always inherit
+  #endif
+  if (spans) {
+    header->bytes[header->length++] = SPANS_BIT | word_wrap_bits;
+    settings |= EXTENDED_BITS;
+  } else {
+    settings |= word_wrap_bits;
+  }
+
+  #if CHUNK_STYLES
+  //Settings: If Background Color is specified, add it and flag it in Settings
+  if (background_color.argb!=GColorClear.argb) {
+    header->bytes[header->length++] = background_color.argb;
+    settings |= BACKGROUND_COLOR_BIT;
   }
+  #endif
 
-  //Settings: If Text Color is specified, copy to Buffer and flag it in Settings
+  #if CHUNK_COLORS
+  //Settings: If Text Color is specified, add it and flag it in Settings
   if (text_color.argb!=GColorClear.argb) {
-    console_data->buffer[console_data->pos-- % console_data->buffer_size] = text_color.argb;
+    header->bytes[header->length++] = text_color.argb;
     settings |= TEXT_COLOR_BIT;
   }
+  #else
+  (void)text_color;
+  #endif
 
-  //Settings: If Background Color is specified, copy to Buffer and flag it in Settings
-  if (background_color.argb!=GColorClear.argb) {
-    console_data->buffer[console_data->pos-- % console_data->buffer_size] = background_color.argb;
-    settings |= BACKGROUND_COLOR_BIT;
+  #if CHUNK_STYLES
+  // Settings: If a Font is specified, add it (last byte first) and flag it in Settings
+  if (font) {
+    for (uintptr_t i=sizeof(font); i>0; i--)
+      header->bytes[header->length++] = ((uint8_t*)&font)[i-1];
+    settings |= FONT_BIT;
   }
 
-  // Settings: Flag Word Wrap in Settings, even it if it's "inherit from console_layer"
-  settings |= (word_wrap & WORD_WRAP_BITS);
-  
   // Settings: Flag Alignment in Settings, even if it's "inherit from console_layer"
   settings |= (alignment==GTextAlignmentLeft?0b0000 : alignment==GTextAlignmentCenter?0b0100 : alignment==GTextAlignmentRight?0b1000 : 0b1100);
+  #else
+  settings |= ALIGNMENT_BITS;  // Profile doesn't support it: Always inherit
+  #endif
+
+  header->bytes[0] = settings;
+}
+
+//----------------------------------------------//
+
+// Finds where a line ends: at 0, or also at \n if splitting
+static const char* console_line_end(const char *text, bool split, bool *escapes) {
+  *escapes = false;
+  for (; *text && !(split && *text=='\n'); text++)
+    if (*text == ESCAPE_CHARACTER) *escapes = true;
+  return text;
+}
+
+// Gets the next line to write, returning false if there are no more
+static bool console_next_line(console_lines *lines, console_chunk *chunk) {
+  if (lines->array) {
+    if (lines->count == 0) return false;
+    lines->count--;
+    chunk->text = *(lines->array++);
+    chunk->end  = console_line_end(chunk->text, false, &chunk->escapes);
+  } else {
+    if (!lines->text) return false;
+    chunk->text = lines->text;
+    chunk->end  = console_line_end(chunk->text, true, &chunk->escapes);
+    lines->text = *chunk->end && chunk->end[1] ? chunk->end + 1 : NULL;  // A \n at the very end doesn't start another line
+  }
+  #if !CHUNK_COLORS
+  chunk->escapes = false;  // Profile doesn't parse them: Written as they are
+  #endif
+  return true;
+}
+
+// Longest length up to limit which doesn't cut a UTF-8 character in two (counting text without escape sequences)
+static size_t console_utf8_limit(const console_chunk *chunk, size_t limit) {
+  size_t length = 0, boundary = 0;
+  for (const char *text = chunk->text; text < chunk->end && length <= limit;) {
+    #if CHUNK_COLORS
+    if (chunk->escapes && *text == ESCAPE_CHARACTER) {
+      text = console_read_escape(text, chunk->end, &(GColor){.argb = 0});
+      continue;
+    }
+    #endif
+    if ((*text & 0xC0) != 0x80) boundary = length;  // Not a continuation byte, so a character starts here
+    length++;
+    text++;
+  }
+  return length <= limit ? length : boundary;
+}
+
+// Finds the next run of text between escape sequences: Moves text to its start and returns its size (0 = no more)
+static size_t console_chunk_run(const console_chunk *chunk, const char **text, size_t left) {
+  #if CHUNK_COLORS
+  if (chunk->escapes) {
+    while (left && *text < chunk->end && **text == ESCAPE_CHARACTER)
+      *text = console_read_escape(*text, chunk->end, &(GColor){.argb = 0});
+    const char *run = *text;
+    while (run < chunk->end && *run != ESCAPE_CHARACTER && (size_t)(run - *text) < left) run++;
+    return run - *text;
+  }
+  #else
+  (void)chunk; (void)text;  // Profile doesn't parse them: The text is one run
+  #endif
+  return left;
+}
+
+// Works out how many bytes the chunk's text takes up packed, and from where (if anywhere) it's smaller to write the rest as it is
+static size_t console_pack_size(console_chunk *chunk) {
+  size_t nibbles = 0, index = 0, left = chunk->length, best = SIZE_MAX;
+  for (const char *text = chunk->text; left;) {
+    size_t size = console_chunk_run(chunk, &text, left);
+    if (!size) break;
+    for (size_t i = 0; i < size; i++, index++) {
+      size_t plain = (nibbles + 2 + 1) / 2 + (chunk->length - index);  // 15, 0 (rounded up to a byte), then the rest
+      if (plain < best) {
+        best = plain;
+        chunk->plain_from = index;
+      }
+      uint8_t character_nibbles = console_packed_nibbles(text[i]);
+      if (!character_nibbles) return best;  // Can't be packed: The rest has to be as it is
+      nibbles += character_nibbles;
+    }
+    text += size;
+    left -= size;
+  }
+  if ((nibbles + 1) / 2 <= best) {
+    best = (nibbles + 1) / 2;
+    chunk->plain_from = chunk->length;
+  }
+  return best;
+}
+
+// Works out what a chunk will take up in a buffer with room for capacity bytes, truncating its text if it's too big.
+// Returns the chunk's size in bytes (0 = doesn't fit at all)
+static size_t console_prepare_chunk(console_chunk *chunk, const console_header headers[2], size_t capacity, bool packed) {
+  chunk->length = chunk->end - chunk->text;
+  chunk->span_count = 0;
+  chunk->truncated = false;
+  chunk->packed = packed;
+  #if CHUNK_COLORS
+  if (chunk->escapes)
+    chunk->length = console_parse_spans(chunk->text, chunk->end, chunk->spans, &chunk->span_count);
+  #endif
+
+  // Settings, span table (count and 2 bytes per span), text, EndOfString and length (and 15, 0 if the text can't be packed smaller)
+  size_t overhead = headers[0].length + (chunk->span_count ? 2 + 2*chunk->span_count : 0) + 1 + CHUNK_LENGTH + packed;
+  chunk->truncated = overhead + chunk->length > capacity;
+  if (overhead > capacity) return 0;
+  if (chunk->truncated) {
+    // Too big for the whole buffer: Keep as much as fits, and only the spans which still have text
+    chunk->length = console_utf8_limit(chunk, capacity - overhead);
+    size_t start = 0;
+    for (uint8_t i = 0; i < chunk->span_count; i++) {
+      if (start >= chunk->length) {chunk->span_count = i; break;}
+      start += chunk->spans[i].length;
+    }
+  }
+  chunk->header = &headers[chunk->span_count ? 1 : 0];
+  chunk->plain_from = 0;
+  chunk->stored = packed ? console_pack_size(chunk) : chunk->length;
+  return chunk->header->length + (chunk->span_count ? 1 + 2*chunk->span_count : 0) + chunk->stored + 1 + CHUNK_LENGTH;
+}
+
+// Copies bytes into the buffer at position at (wrapping around the end of the buffer), then moves at past them
+static void console_ring_copy(console_ring *ring, uintptr_t *at, const void *bytes, size_t size) {
+  uintptr_t index = *at % ring->buffer_size;
+  size_t first = ring->buffer_size - index < size ? ring->buffer_size - index : size;
+  memcpy(&ring->buffer[index], bytes, first);
+  memcpy(ring->buffer, (const uint8_t*)bytes + first, size - first);
+  *at = index + size;
+}
+
+// Writes a prepared chunk of size bytes just before pos, so it becomes the newest chunk.  Doesn't write the EOF 0.
+// Buffer: |...|0|<--older chunks   becomes   |...|0|Settings|SpanTable|string|0|Length|<--older chunks
+static void console_ring_write_chunk(console_ring *ring, const console_chunk *chunk, size_t size) {
+  ring->pos = (ring->pos + ring->buffer_size - size) % ring->buffer_size;
+  uintptr_t at = ring->pos + 1;
+
+  console_ring_copy(ring, &at, chunk->header->bytes, chunk->header->length);
+
+  #if CHUNK_COLORS
+  if (chunk->span_count) {
+    // Span table: count, then each span's length and color
+    uint8_t table[1 + 2*MAX_SPANS];
+    table[0] = chunk->span_count;
+    for (uint8_t i = 0; i < chunk->span_count; i++) {
+      table[1 + 2*i] = chunk->spans[i].length;
+      table[2 + 2*i] = chunk->spans[i].color.argb;
+    }
+    console_ring_copy(ring, &at, table, 1 + 2*chunk->span_count);
+  }
+  #endif
+
+  // Text between the escape sequences: Packed up to plain_from, then as it is
+  console_packer packer = {.ring = ring, .at = at};
+  size_t index = 0, left = chunk->length;
+  for (const char *text = chunk->text; left;) {
+    size_t size = console_chunk_run(chunk, &text, left);
+    if (!size) break;
+    size_t i = 0;
+    for (; i < size && index < chunk->plain_from; i++, index++)
+      console_pack_char(&packer, text[i]);
+    if (i < size) {
+      if (chunk->packed && index == chunk->plain_from) console_pack_plain(&packer);
+      console_ring_copy(ring, &packer.at, &text[i], size - i);
+      index += size - i;
+    }
+    text += size;
+    left -= size;
+  }
+  if (packer.half) console_pack_nibble(&packer, PACKED_RAW);  // Pad the odd nibble out
+
+  ring->buffer[packer.at % ring->buffer_size] = 0;  // EndOfString
+  #if (console_layer_chunk_lengths)
+  ring->buffer[(packer.at + 1) % ring->buffer_size] = size <= UINT8_MAX ? size : 0;  // 0 = too long to say
+  #endif
+}
+
+//----------------------------------------------//
+// Valid Chunks
+//----------------------------------------------//
+// New chunks write over the oldest ones, and the last of those may only be cut into (see the Buffer Description).
+// Each ring keeps where its oldest whole chunk starts, so readers stop there before reading anything cut into.
+// With chunk lengths, the chunk before a cut one is found from the length byte at its end.  Without them (or for
+//   chunks too long for it), the ring is marked stale and the next reader walks it from the newest chunk.
+
+// Skips the Settings bytes of the chunk at cursor, returning the cursor on the last of them (just before its string)
+static intptr_t console_ring_skip_settings(const console_ring *ring, intptr_t cursor, bool stamped) {
+  uint8_t settings = ring->buffer[cursor % ring->buffer_size];
+  uint8_t extended = 0;
+  if (stamped) cursor += 4;
+  if ((settings&EXTENDED_BITS) == EXTENDED_BITS) extended = ring->buffer[++cursor % ring->buffer_size];
+  if (settings&BACKGROUND_COLOR_BIT) cursor++;
+  if (settings&TEXT_COLOR_BIT)       cursor++;
+  if (settings&FONT_BIT)             cursor += sizeof(GFont);
+  if (extended&SPANS_BIT) {
+    uint8_t span_count = ring->buffer[++cursor % ring->buffer_size];
+    cursor += 2 * span_count;
+  }
+  return cursor;
+}
+
+// Finds the oldest whole chunk by walking the ring from the newest
+static void console_ring_find_oldest(console_ring *ring, bool stamped) {
+  ring->oldest = ring->used = 0;
+  ring->stale = false;
+  intptr_t cursor = ring->pos + 1;  // Get past the EOF 0
+  while (ring->buffer[cursor % ring->buffer_size]) {
+    intptr_t start = cursor;
+    cursor = console_ring_skip_settings(ring, cursor, stamped);
+    while (cursor - ring->pos < ring->buffer_size && ring->buffer[++cursor % ring->buffer_size]);  // Get to its EndOfString
+    cursor += CHUNK_LENGTH;
+    if (cursor - ring->pos >= ring->buffer_size) break;  // Written over
+    ring->oldest = start - ring->pos;
+    ring->used   = cursor - ring->pos;
+    cursor++;
+  }
+}
+
+// Where the oldest whole chunk starts, counted from pos (0 = no chunks).  Readers stop at any chunk past it.
+static uintptr_t console_ring_oldest(console_ring *ring, bool stamped) {
+  if (ring->stale) console_ring_find_oldest(ring, stamped);
+  return ring->oldest;
+}
+
+// Drops the oldest chunks a chunk of size bytes is about to cut into, and counts it in as the newest.
+// Called just before it's written, while the length bytes of the chunks it cuts into are still there.
+static void console_ring_add_chunk(console_ring *ring, size_t size) {
+  if (ring->stale) return;  // Found when it's next read
+  while (ring->oldest && ring->used + size >= ring->buffer_size) {
+    // It'd be cut into: The next oldest ends just before it
+    ring->used = ring->oldest - 1;
+    if (!ring->used) {
+      ring->oldest = 0;  // No chunks left
+      break;
+    }
+    #if (console_layer_chunk_lengths)
+    uint8_t length = ring->buffer[(ring->pos + ring->used) % ring->buffer_size];
+    if (length && length <= ring->used && ring->buffer[(ring->pos + ring->used - length + 1) % ring->buffer_size] & SETTINGS_BIT) {
+      ring->oldest = ring->used - length + 1;
+      continue;
+    }
+    #endif
+    ring->stale = true;
+    return;
+  }
+  ring->oldest = ring->oldest ? ring->oldest + size : 1;
+  ring->used  += size;
+}
+
+//----------------------------------------------//
+
+// Adds the stamp after the Settings byte, for chunks in the priority ring
+static void console_header_add_stamp(console_header *header, uint32_t stamp) {
+  memmove(&header->bytes[5], &header->bytes[1], header->length - 1);
+  for (uint8_t i = 0; i < 4; i++)
+    header->bytes[1 + i] = stamp >> (8 * i);
+  header->length += 4;
+}
+
+// Writes lines as separate chunks, oldest first, with the style worked out once and one dirty mark for all of them.
+// There's nothing to evict: Newer chunks just write over the oldest ones, which stop being drawn once they're cut into
+//   (see Valid Chunks).
+// High priority lines go in the priority ring (if there is one), which only other high priority lines write over.
+static void console_log_write_lines_internal(ConsoleLog *console_log, console_lines lines, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap, ConsolePriority priority) {
+  console_ring *ring = priority==ConsolePriorityHigh && console_log->priority.buffer_size ? &console_log->priority : &console_log->ring;
+  console_header headers[2];  // Without and with a span table
+  console_build_header(&headers[0], text_color, background_color, font, alignment, word_wrap, false);
+  console_build_header(&headers[1], text_color, background_color, font, alignment, word_wrap, true);
+  if (ring == &console_log->priority) {
+    // Priority chunks save how many normal chunks came before them, so they can be shown in between them
+    console_header_add_stamp(&headers[0], console_log->stamp);
+    console_header_add_stamp(&headers[1], console_log->stamp);
+  }
+  size_t capacity = ring->buffer_size - 1;  // Room for everything but the EOF 0
+  console_chunk chunk;
+
+  while (console_next_line(&lines, &chunk)) {
+    size_t size = console_prepare_chunk(&chunk, headers, capacity, console_log->packed);
+    if (size) {
+      console_ring_add_chunk(ring, size);
+      console_ring_write_chunk(ring, &chunk, size);
+      if (ring == &console_log->ring) console_log->stamp++; else console_log->priority_count++;
+    }
+    // A truncated line has pushed all the older text out, but may not have written over all of it:
+    //   End the text just after it, so none of what's left shows
+    if (chunk.truncated) {
+      ring->buffer[(ring->pos + size + 1) % ring->buffer_size] = 0;
+      ring->oldest = size ? 1 : 0;
+      ring->used   = size;
+      ring->stale  = false;
+    }
+  }
 
-  // Save settings
-  console_data->buffer[console_data->pos-- % console_data->buffer_size] = settings;
-  
   // EOF -- Head/Tail buffer transition point
-  console_data->buffer[console_data->pos % console_data->buffer_size] = 0;
+  ring->buffer[ring->pos] = 0;
 
-  // Fix pos
-  console_data->pos %= console_data->buffer_size;
-  
-  MARK_DIRTY;
+  MARK_LOG_DIRTY;
+}
+
+//----------------------------------------------//
+
+#if (console_layer_trace)
+// Adds the line count and their total length to a Write Lines record
+static void trace_lines(console_lines lines) {
+  console_chunk chunk;
+  size_t count = 0, length = 0;
+  while (console_next_line(&lines, &chunk)) {
+    count++;
+    length += chunk.end - chunk.text;
+  }
+  trace_u16(count  > UINT16_MAX ? UINT16_MAX : count);
+  trace_u16(length > UINT16_MAX ? UINT16_MAX : length);
 }
+#endif
 
 //----------------------------------------------//
 
+void console_log_write_text_priority(ConsoleLog *console_log, char *text, ConsolePriority priority, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
+  TRACE(trace_style(priority==ConsolePriorityHigh ? ConsoleTraceWritePriority : ConsoleTraceWrite, console_log, text_color, background_color, font, alignment, word_wrap));
+  TRACE(trace_u16(strlen(text)));
+  console_log_write_lines_internal(console_log, (console_lines){.array = (const char**)&text, .count = 1}, text_color, background_color, font, alignment, word_wrap, priority);
+}
+
+void console_log_write_text_styled(ConsoleLog *console_log, char *text, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
+  console_log_write_text_priority(console_log, text, ConsolePriorityNormal, text_color, background_color, font, alignment, word_wrap);
+}
+
+void console_log_write_text(ConsoleLog *console_log, char *text) {
+  // Write text and inherit all settings from the console_layer(s) showing it
+  console_log_write_text_styled(console_log, text, GColorInherit, GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit);
+}
+
+void console_log_write_lines(ConsoleLog *console_log, const char **lines, size_t count, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
+  TRACE(trace_style(ConsoleTraceWriteLines, console_log, text_color, background_color, font, alignment, word_wrap));
+  TRACE(trace_lines((console_lines){.array = lines, .count = count}));
+  console_log_write_lines_internal(console_log, (console_lines){.array = lines, .count = count}, text_color, background_color, font, alignment, word_wrap, ConsolePriorityNormal);
+}
+
+void console_log_write_split(ConsoleLog *console_log, const char *text, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
+  TRACE(trace_style(ConsoleTraceWriteLines, console_log, text_color, background_color, font, alignment, word_wrap));
+  TRACE(trace_lines((console_lines){.text = text}));
+  console_log_write_lines_internal(console_log, (console_lines){.text = text}, text_color, background_color, font, alignment, word_wrap, ConsolePriorityNormal);
+}
+
+
+//------------------------------------------------------------------------------------------------//
+// Write Layer
+//----------------------------------------------//
+// Writing to a layer writes to the log it's showing (if it isn't showing one, the text is dropped)
+
+void console_layer_clear(Layer *console_layer) {
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  if (console_log) console_log_clear(console_log);
+}
+
+void console_layer_write_text_styled(Layer *console_layer, char *text, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  if (console_log) console_log_write_text_styled(console_log, text, text_color, background_color, font, alignment, word_wrap);
+}
+
 void console_layer_write_text(Layer *console_layer, char *text) {
   // Write text and inherit all settings from the console_layer
   console_layer_write_text_styled(console_layer, text, GColorInherit, GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit);
 }
 
+void console_layer_write_text_priority(Layer *console_layer, char *text, ConsolePriority priority, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  if (console_log) console_log_write_text_priority(console_log, text, priority, text_color, background_color, font, alignment, word_wrap);
+}
+
+void console_layer_write_lines(Layer *console_layer, const char **lines, size_t count, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  if (console_log) console_log_write_lines(console_log, lines, count, text_color, background_color, font, alignment, word_wrap);
+}
+
+void console_layer_write_split(Layer *console_layer, const char *text, GColor text_color, GColor background_color, GFont font, GTextAlignment alignment, int word_wrap) {
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  if (console_log) console_log_write_split(console_log, text, text_color, background_color, font, alignment, word_wrap);
+}
+
 
 
 
 
+//------------------------------------------------------------------------------------------------//
+// Built-in Glyphs
+//----------------------------------------------//
+// Text in GFontConsoleGlyphs is drawn straight into the frame buffer from the atlas below, so it never goes through
+//   the system's text engine.  Lines break at \n, and if word wrapping, at the last space that fits (or mid-word).
+#if (console_layer_glyphs)
+#define GLYPH_WIDTH        5         // Pixels across and down each glyph in the atlas
+#define GLYPH_HEIGHT       7
+#define GLYPH_ADVANCE      6         // Glyph plus a column of space
+#define GLYPH_LINE         9         // Line height: a row of space above and below (about GOTHIC_09's)
+#define GLYPH_BOX         95         // Drawn for characters without a glyph
+#define GLYPH_ELLIPSIS    96         // Drawn in place of the last character of a line that's cut short
+
+// Printable ASCII (' ' to '~'), then a box and an ellipsis.  Each glyph is 5 columns, left to right, top row in bit 0.
+const uint8_t console_glyph_atlas[97][GLYPH_WIDTH] = {
+  {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},  //  !"#
+  {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00},  // $%&'
+  {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08},  // ()*+
+  {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},  // ,-./
+  {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},  // 0123
+  {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},  // 4567
+  {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},  // 89:;
+  {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},  // <=>?
+  {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},  // @ABC
+  {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x01,0x01}, {0x3E,0x41,0x41,0x51,0x32},  // DEFG
+  {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},  // HIJK
+  {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x04,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},  // LMNO
+  {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},  // PQRS
+  {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x7F,0x20,0x18,0x20,0x7F},  // TUVW
+  {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},  // XYZ[
+  {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},  // \]^_
+  {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},  // `abc
+  {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x08,0x54,0x54,0x54,0x3C},  // defg
+  {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x00,0x7F,0x10,0x28,0x44},  // hijk
+  {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},  // lmno
+  {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},  // pqrs
+  {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},  // tuvw
+  {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},  // xyz{
+  {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08},                              // |}~
+  {0x7F,0x41,0x41,0x41,0x7F}, {0x40,0x00,0x40,0x00,0x40},                                                           // Box, ellipsis
+};
+
+static const char* console_utf8_next(const char *text) {
+  do text++; while ((*text & 0xC0) == 0x80);  // Past any continuation bytes
+  return text;
+}
+
+// Finds the end of the line of glyphs starting at text, at most columns characters long.  Returns how many
+//   characters it has, with *end set to just after them and *next to the start of the next line.
+static uint16_t console_glyph_line(const char *text, uint16_t columns, bool word_wrap, const char **end, const char **next) {
+  const char *space = NULL;
+  uint16_t count = 0, space_count = 0;
+  while (*text && *text != '\n') {
+    if (count == columns) {
+      if (word_wrap && *text != ' ' && space) {  // Break at the last space instead of mid-word
+        text = space;
+        count = space_count;
+      }
+      break;
+    }
+    if (*text == ' ') {
+      space = text;
+      space_count = count;
+    }
+    text = console_utf8_next(text);
+    count++;
+  }
+  *end = text;
+  *next = *text == '\n' || *text == ' ' ? text + 1 : text;  // The \n or space it broke at isn't on either line
+  return count;
+}
+
+// Lines text takes up, word wrapped to width pixels (empty text takes none)
+static uint16_t console_glyph_lines(const char *text, int16_t width) {
+  uint16_t columns = width < GLYPH_ADVANCE ? 1 : width / GLYPH_ADVANCE, lines = 0;
+  const char *end;
+  while (*text) {
+    console_glyph_line(text, columns, true, &end, &text);
+    lines++;
+    if (!*end) break;
+    if (!*text) lines++;  // Ends in \n: an empty last line
+  }
+  return lines;
+}
+
+// Light colors are white on a black and white screen
+static void console_draw_glyph(const GBitmapDataRowInfo *rows, bool one_bit, int16_t x, int16_t min_x, int16_t max_x, uint8_t glyph, GColor color) {
+  bool white = color.r + color.g + color.b >= 6;
+  for (uint8_t column = 0; column < GLYPH_WIDTH; column++, x++) {
+    uint8_t bits = console_glyph_atlas[glyph][column];
+    if (!bits || x < min_x || x > max_x) continue;
+    for (uint8_t row = 0; row < GLYPH_HEIGHT; row++)
+      if (bits & (1 << row) && rows[row].data && x >= rows[row].min_x && x <= rows[row].max_x) {
+        if (one_bit) {
+          uint8_t *byte = &rows[row].data[x / 8];
+          *byte = white ? *byte | (1 << (x % 8)) : *byte & ~(1 << (x % 8));
+        } else {
+          rows[row].data[x] = color.argb;
+        }
+      }
+  }
+}
+
+// Draws text in glyphs inside rect (clipped to the layer), each inline style span in its own color
+static void console_draw_glyphs(GContext *ctx, Layer *layer, const char *text, const console_span *spans, uint8_t span_count, GColor text_color, GRect rect, GTextAlignment alignment, bool word_wrap) {
+  GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+  if (!frame_buffer) return;
+  bool one_bit = gbitmap_get_format(frame_buffer) == GBitmapFormat1Bit;
+
+  // Everything from here on is in screen coordinates, clipped to the layer and the screen
+  GRect clip   = layer_convert_rect_to_screen(layer, (GRect){.origin = GPointZero, .size = layer_get_bounds(layer).size});
+  GRect screen = gbitmap_get_bounds(frame_buffer);
+  int16_t min_x = clip.origin.x > screen.origin.x ? clip.origin.x : screen.origin.x;
+  int16_t min_y = clip.origin.y > screen.origin.y ? clip.origin.y : screen.origin.y;
+  int16_t max_x = (clip.origin.x + clip.size.w < screen.origin.x + screen.size.w ? clip.origin.x + clip.size.w : screen.origin.x + screen.size.w) - 1;
+  int16_t max_y = (clip.origin.y + clip.size.h < screen.origin.y + screen.size.h ? clip.origin.y + clip.size.h : screen.origin.y + screen.size.h) - 1;
+  GPoint origin = layer_convert_point_to_screen(layer, rect.origin);
+
+  uint16_t columns = rect.size.w < GLYPH_ADVANCE ? 1 : rect.size.w / GLYPH_ADVANCE;
+  const char *start = text, *end, *next;
+  uint8_t span = 0;
+  size_t span_end = span_count ? spans[0].length : 0;  // Where the span's text ends (the last span runs to the end)
+  for (int16_t top = origin.y + 1; top <= max_y; top += GLYPH_LINE) {
+    uint16_t count = console_glyph_line(text, columns, word_wrap, &end, &next);
+    bool cut_short = !word_wrap && *end;
+    int16_t width = count * GLYPH_ADVANCE - 1;
+    int16_t x = origin.x + (alignment==GTextAlignmentCenter ? (rect.size.w - width) / 2 : alignment==GTextAlignmentRight ? rect.size.w - width : 0);
+    if (x < origin.x) x = origin.x;
+
+    // The line's rows of the frame buffer (no data = clipped)
+    GBitmapDataRowInfo rows[GLYPH_HEIGHT];
+    for (uint8_t row = 0; row < GLYPH_HEIGHT; row++)
+      rows[row] = top + row >= min_y && top + row <= max_y ? gbitmap_get_data_row_info(frame_buffer, top + row) : (GBitmapDataRowInfo){.data = NULL};
+
+    if (top + GLYPH_HEIGHT > min_y)
+      for (uint16_t i = 0; i < count && x <= max_x; i++, x += GLYPH_ADVANCE, text = console_utf8_next(text)) {
+        while (span + 1 < span_count && (size_t)(text - start) >= span_end)
+          span_end += spans[++span].length;
+        GColor color = span_count && spans[span].color.argb!=GColorClear.argb ? spans[span].color : text_color;
+        uint8_t c = *text == '\t' ? ' ' : *text;
+        uint8_t glyph = cut_short && i + 1 == count ? GLYPH_ELLIPSIS : c >= ' ' && c <= '~' ? c - ' ' : GLYPH_BOX;
+        if (color.argb!=GColorClear.argb)
+          console_draw_glyph(rows, one_bit, x, min_x, max_x, glyph, color);
+      }
+    if (!word_wrap || !*end) break;
+    text = next;
+  }
+  graphics_release_frame_buffer(ctx, frame_buffer);
+}
+#endif
+
+// Height of text in font, word wrapped to width pixels
+static int16_t console_text_height(const char *text, GFont font, int16_t width, GTextAlignment alignment) {
+  #if (console_layer_glyphs)
+  if (font == GFontConsoleGlyphs) return console_glyph_lines(text, width) * GLYPH_LINE;
+  #endif
+  return graphics_text_layout_get_content_size(text, font, GRect(0, 0, width, 0x7FFF), GTextOverflowModeTrailingEllipsis, alignment).h;
+}
+
+
 //------------------------------------------------------------------------------------------------//
 // Draw Layer
 //----------------------------------------------//
+#if CHUNK_COLORS
+// Width of "|" in the last font a run with a trailing space was measured in (measured again when the font changes)
+static GFont   bar_font;
+static int16_t bar_width;
+
+// Width of the text from run to end (end is temporarily 0-terminated, so end must be within the string)
+static int16_t console_measure_run(char *run, char *end, GFont font) {
+  char saved[2] = {end[0], end[0] ? end[1] : 0};
+  bool trailing_space = end > run && end[-1] == ' ' && end[0];
+  if (trailing_space) {
+    // Pebble doesn't count trailing spaces, so measure "run|" and take away the width of "|"
+    end[0] = '|';
+    end[1] = 0;
+  } else {
+    end[0] = 0;
+  }
+  int16_t width = graphics_text_layout_get_content_size(run, font, GRect(0, 0, 0x7FFF, 0x7FFF), GTextOverflowModeTrailingEllipsis, GTextAlignmentLeft).w;
+  if (trailing_space) {
+    if (font != bar_font || !bar_width) {
+      bar_width = graphics_text_layout_get_content_size("|", font, GRect(0, 0, 0x7FFF, 0x7FFF), GTextOverflowModeTrailingEllipsis, GTextAlignmentLeft).w;
+      bar_font  = font;
+    }
+    width -= bar_width;
+  }
+  end[0] = saved[0];
+  if (trailing_space) end[1] = saved[1];
+  return width;
+}
+
+// Draws a chunk with inline styles on one line, each span in its own color
+// Modifies Graphics Context: Text Color
+static void console_draw_spans(GContext *ctx, char *text, console_span *spans, uint8_t span_count, GFont font, GColor text_color, GRect rect, GTextAlignment alignment) {
+  char *end[MAX_SPANS];
+  int16_t width[MAX_SPANS], total_width = 0;
+
+  // Measure each span (the last span runs to the end of the string, and left aligned, nothing needs its width)
+  char *run = text;
+  for (uint8_t i = 0; i < span_count; i++) {
+    end[i] = run;
+    if (i + 1 < span_count)
+      for (uint8_t j = 0; j < spans[i].length && *end[i]; j++) end[i]++;
+    else
+      while (*end[i]) end[i]++;
+    width[i] = i + 1 < span_count || alignment != GTextAlignmentLeft ? console_measure_run(run, end[i], font) : 0;
+    total_width += width[i];
+    run = end[i];
+  }
+
+  // Alignment applies to the line as a whole
+  int16_t x = alignment==GTextAlignmentCenter ? (rect.size.w - total_width) / 2 : alignment==GTextAlignmentRight ? rect.size.w - total_width : 0;
+  if (x < 0) x = 0;
+
+  // Draw each span where the previous one ended
+  run = text;
+  for (uint8_t i = 0; i < span_count && x < rect.size.w; i++) {
+    GColor color = spans[i].color.argb!=GColorClear.argb ? spans[i].color : text_color;
+    if (color.argb!=GColorClear.argb && run != end[i]) {  // Pebble renders clear text as black
+      char saved = *end[i];
+      *end[i] = 0;
+      graphics_context_set_text_color(ctx, color);
+      graphics_draw_text(ctx, run, font, GRect(rect.origin.x + x, rect.origin.y, rect.size.w - x, rect.size.h), GTextOverflowModeTrailingEllipsis, GTextAlignmentLeft, NULL);
+      *end[i] = saved;
+    }
+    x += width[i];
+    run = end[i];
+  }
+}
+#endif
+
+//----------------------------------------------//
+// Reads the stamp of the priority chunk at cursor
+static uint32_t console_ring_stamp(const console_ring *ring, intptr_t cursor) {
+  uint32_t stamp = 0;
+  for (uint8_t i = 4; i > 0; i--)
+    stamp = stamp << 8 | (uint8_t)ring->buffer[(cursor + i) % ring->buffer_size];
+  return stamp;
+}
+
+#if CHUNK_STYLES
+// Settings' Alignment bits to alignment (0b11 = Inherit from layer)
+static const GTextAlignment ALIGNMENTS[3] = {GTextAlignmentLeft, GTextAlignmentCenter, GTextAlignmentRight};
+#endif
+
 // Modifies Graphics Context: Fill Color, Text Color
 static void console_layer_update(Layer *console_layer, GContext *ctx) {
   console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
   GRect bounds = layer_get_bounds(console_layer);
+  #if (console_layer_trace)
+  uint32_t trace_start = trace_now();
+  uint8_t  trace_rows  = 0;
+  #endif
 
   // Layer Background
   if (console_data->background_color.argb!=GColorClear.argb) {
@@ -266,91 +1480,545 @@ static void console_layer_update(Layer *console_layer, GContext *ctx) {
     graphics_fill_rect(ctx, (GRect){.origin = GPoint(0, 0), .size = bounds.size}, 0, GCornerNone);
   }
 
-  // Display Text
-  //char text[console_data->buffer_size + 1];         // allocate on stack (Locks up when using DictationAPI and a large buffer)
-  char *text = malloc(console_data->buffer_size + 1); // allocate on heap
+  // The log gets what's left between the pinned lines' slots (they draw themselves, see Pinned Lines)
+  bounds.origin.y += console_data->pinned_top;
+  bounds.size.h   -= console_data->pinned_top + console_data->pinned_bottom;
+
+  // Display Text (if the layer is showing a log)
+  ConsoleLog *console_log = console_data->log;
+  size_t text_size = console_log ? console_log->ring.buffer_size + console_log->priority.buffer_size + 1 : 0;  // Room for the whole buffer
+  //char text[text_size];         // allocate on stack (Locks up when using DictationAPI and a large buffer)
+  char *text = console_log ? malloc(text_size) : NULL; // allocate on heap
   if (text) {  // verify heap allocation was successful
     int16_t y = bounds.size.h; // Start at the bottom of layer
-    uint8_t settings;
-    intptr_t cursor = console_data->pos + 1;  // Get past the EOF 0
-
-    // While text is within visible bounds && not at EOF (also, if not EOF, copy byte to settings)
-    while (y>bounds.origin.y && (settings = console_data->buffer[cursor % console_data->buffer_size])) {
-
+    console_ring *rings[2] = {&console_log->ring, &console_log->priority};
+    intptr_t cursors[2] = {console_log->ring.pos + 1, console_log->priority.pos + 1};  // Get past the EOF 0s
+    uintptr_t oldest[2] = {console_ring_oldest(rings[0], false), console_ring_oldest(rings[1], true)};
+    uint32_t age = 0;  // Normal chunks gone past so far
+
+    #if !CHUNK_STYLES
+    // Profile doesn't support per-text styles: All text uses the layer's
+    bool           word_wrap  = console_data->word_wrap;
+    GTextAlignment alignment  = console_data->alignment;
+    GFont          font       = console_data->font;
+    #endif
+    #if !CHUNK_COLORS
+    GColor         text_color = console_data->text_color;
+    graphics_context_set_text_color(ctx, text_color);
+    #endif
+
+    // While text is within visible bounds
+    while (y>0) {
+      // Next chunk: The newer of the next normal and next priority chunks (0 = past the oldest whole chunk, see Valid Chunks)
+      // A priority chunk is newer if no more normal chunks were written after it than have been gone past
+      uint8_t normal = cursors[0] - rings[0]->pos <= oldest[0] ? rings[0]->buffer[cursors[0] % rings[0]->buffer_size] : 0;
+      uint8_t high   = cursors[1] - rings[1]->pos <= oldest[1] ? rings[1]->buffer[cursors[1] % rings[1]->buffer_size] : 0;
+      if (!normal && !high) break;
+      bool is_high = high && (!normal || console_log->stamp - console_ring_stamp(rings[1], cursors[1]) <= age);
+      console_ring *ring = rings[is_high];
+      intptr_t cursor = cursors[is_high];
+      uint8_t settings = is_high ? high : normal;
+      if (is_high)
+        cursor += 4;  // Get past the stamp
+      else
+        age++;
+
+      #if CHUNK_COLORS
+      // If Extended Settings are specified, copy from buffer.  They hold the real Word Wrap bits.
+      uint8_t extended = (settings&EXTENDED_BITS) == EXTENDED_BITS ? ring->buffer[++cursor % ring->buffer_size] : (settings&WORD_WRAP_BITS);
+      #endif
+
+      #if CHUNK_STYLES
       // Extract word_wrap from settings
-      bool word_wrap = settings&WORD_WRAP_INHERIT_BIT ? console_data->word_wrap : settings&WORD_WRAP_BIT;
-
-      // Extract Alignment from Settings (and if it's inherit, get it from layer, unless THAT's also inherit then default to left)
-      // This could be quicker if I could just assume the enum: GTextAlignmentLeft=0, Center=1 and Right=2 (which it does),
-      // but I can't cause it'd lose abstraction.  Not that I already didn't lose it by adding "GTextAlignmentInherit"
-      GTextAlignment alignment;
-      switch (settings & ALIGNMENT_BITS) {
-        case 0b0000: alignment = GTextAlignmentLeft;   break;
-        case 0b0100: alignment = GTextAlignmentCenter; break;
-        case 0b1000: alignment = GTextAlignmentRight;  break;
-        default:  // 0b1100 = Inherit from layer
-        //Method 1:
-//         alignment = console_data->alignment==GTextAlignmentInherit ? GTextAlignmentLeft : console_data->alignment;
-        //Method 2:
-        switch(console_data->alignment) {
-         case GTextAlignmentLeft:
-         case GTextAlignmentCenter:
-         case GTextAlignmentRight:
-           alignment = console_data->alignment;  // Copy alignment from layer
-         break;
-         default:  // Default: Layer is set to Inherit, which doesn't make sense.  Setting alignment to Left as a fallback.
-           alignment = GTextAlignmentLeft;
-        }
-      }
+      bool word_wrap = extended&WORD_WRAP_INHERIT_BIT ? console_data->word_wrap : extended&WORD_WRAP_BIT;
+
+      // Extract Alignment from Settings (and if it's inherit, get it from layer, which is never inherit)
+      uint8_t alignment_bits = (settings & ALIGNMENT_BITS) >> 2;
+      GTextAlignment alignment = alignment_bits < 3 ? ALIGNMENTS[alignment_bits] : console_data->alignment;
 
       // If background color is specified in settings, copy from buffer
       GColor background_color = console_data->background_color;  // Assume inherit from layer
       if (settings&BACKGROUND_COLOR_BIT)
-        background_color = (GColor){.argb=console_data->buffer[++cursor % console_data->buffer_size]};
+        background_color = (GColor){.argb=ring->buffer[++cursor % ring->buffer_size]};
+      #endif
 
+      #if CHUNK_COLORS
       // If text color is specified in settings, copy from buffer
       GColor text_color = console_data->text_color;  // Assume inherit from layer
       if (settings&TEXT_COLOR_BIT)
-        text_color = (GColor){.argb=console_data->buffer[++cursor % console_data->buffer_size]};
+        text_color = (GColor){.argb=ring->buffer[++cursor % ring->buffer_size]};
       graphics_context_set_text_color(ctx, text_color);
+      #endif
 
+      #if CHUNK_STYLES
       // If font is specified in settings, copy from buffer
       GFont font = console_data->font;  // Assume inherit from layer
       if (settings&FONT_BIT)
         for (uintptr_t i=0; i<sizeof(GFont); i++) {
-        ((uint8_t*)&font)[(sizeof(GFont)-1)-i] = console_data->buffer[++cursor % console_data->buffer_size];
+        ((uint8_t*)&font)[(sizeof(GFont)-1)-i] = ring->buffer[++cursor % ring->buffer_size];
       }
+      #endif
+
+      #if CHUNK_COLORS
+      // If a span table is specified in extended settings, copy from buffer
+      console_span spans[MAX_SPANS];
+      uint8_t span_count = 0;
+      if (extended&SPANS_BIT) {
+        span_count = ring->buffer[++cursor % ring->buffer_size];
+        for (uint8_t i=0; i<span_count; i++) {
+          uint8_t length = ring->buffer[++cursor % ring->buffer_size];
+          GColor color   = (GColor){.argb=ring->buffer[++cursor % ring->buffer_size]};
+          if (i < MAX_SPANS) spans[i] = (console_span){.length = length, .color = color};
+        }
+        if (span_count > MAX_SPANS) span_count = MAX_SPANS;
+      }
+      #else
+      uint8_t span_count = 0;
+      console_span *spans = NULL;
+      (void)settings;  // Profile has nothing in Settings to decode
+      (void)spans;
+      #endif
 
       // Copy the 0-terminated string into a temp buffer (because pebble's text functions can't wrap around end of buffer)
       // Sure I could just manipulate the string itself every write, but... uhh...
+      // Packed text is unpacked straight into it, so only chunks being drawn are ever unpacked
+      console_reader reader = {.ring = ring, .cursor = cursor, .packed = console_log->packed};
       intptr_t i = -1;
       do {
-        if (i < (intptr_t)(console_data->buffer_size)) i++;     // Stop it from maxing out
-        text[i] = console_data->buffer[++cursor % console_data->buffer_size];
+        if (i < (intptr_t)(ring->buffer_size)) i++;     // Stop it from maxing out
+        text[i] = console_read_char(&reader);
       } while (text[i]);  // Stop at 0 (EndOfString)
+      cursors[is_high] = reader.cursor + 1 + CHUNK_LENGTH;  // Get past the string terminating 0 (and its length byte)
+
+      // Text with inline styles is always one line
+      int16_t text_height = console_text_height(word_wrap && !span_count?text:" ", font, bounds.size.w, alignment);
+      y -= text_height;
+      if (y<0 && console_data->pinned_top) break;  // Only partly visible: It'd be drawn over the top pinned lines
+      #if CHUNK_STYLES
+      if (text_height>0 && background_color.argb!=GColorClear.argb) {
+        graphics_context_set_fill_color(ctx, background_color);
+        graphics_fill_rect(ctx, GRect(bounds.origin.x, bounds.origin.y + y, bounds.size.w, text_height), 0, GCornerNone);  // fill background
+      }
+      #endif
+
+      // Render Text (y-3 because Pebble's text rendering is dumb and goes outside rect)
+      #if (console_layer_glyphs)
+      if (font == GFontConsoleGlyphs)
+        console_draw_glyphs(ctx, console_layer, text, spans, span_count, text_color, GRect(bounds.origin.x, bounds.origin.y + y, bounds.size.w, text_height), alignment, word_wrap && !span_count);
+      else
+      #endif
+      #if CHUNK_COLORS
+      if (span_count)
+        console_draw_spans(ctx, text, spans, span_count, font, text_color, GRect(bounds.origin.x, bounds.origin.y + (y-3), bounds.size.w, text_height), alignment);
+      else
+      #endif
+      if (text_color.argb!=GColorClear.argb)   // Pebble renders clear text as black
+        graphics_draw_text(ctx, text, font, GRect(bounds.origin.x, bounds.origin.y + (y-3), bounds.size.w, text_height), GTextOverflowModeTrailingEllipsis, alignment, NULL);
+      TRACE(trace_rows += trace_rows < UINT8_MAX);
+    } // END While
+    free(text);     // free up heap (remove this line if allocating on stack)
+  } else if (console_log) {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Unable to display console_layer text: Out of space (%d bytes needed, %d heap bytes free)", (int)text_size, (int)heap_bytes_free());
+  }
 
-      // If we have gone beyond the buffer_size, data is invalid.  Since buffer[cursor%size] is pointing at 0 (EOS), while loop will exit
-      if (cursor - console_data->pos < console_data->buffer_size) {
-        cursor++;  // Get past the string terminating 0 so the while can loop (unless we're now at the EOF 0)
+  TRACE(trace_redraw(console_layer, trace_start, trace_rows));
+}
 
-        int16_t text_height = graphics_text_layout_get_content_size(word_wrap?text:" ", font, GRect(0, 0, bounds.size.w, 0x7FFF), GTextOverflowModeTrailingEllipsis, alignment).h;
-        y -= text_height;
-        if (text_height>0 && background_color.argb!=GColorClear.argb) {
-          graphics_context_set_fill_color(ctx, background_color);
-          graphics_fill_rect(ctx, GRect(bounds.origin.x, bounds.origin.y + y, bounds.size.w, text_height), 0, GCornerNone);  // fill background
-        }
 
-        // Render Text (y-3 because Pebble's text rendering is dumb and goes outside rect)
-        if (text_color.argb!=GColorClear.argb)   // Pebble renders clear text as black
-          graphics_draw_text(ctx, text, font, GRect(bounds.origin.x, bounds.origin.y + (y-3), bounds.size.w, text_height), GTextOverflowModeTrailingEllipsis, alignment, NULL);
-      } // END if data valid
-    } // END While
-    free(text);     // free up heap (remove this line if allocating on stack)
-  } else {
-    APP_LOG(APP_LOG_LEVEL_WARNING, "Unable to display console_layer text: Out of space (%d bytes needed, %d heap bytes free)", (int)console_data->buffer_size + 1, (int)heap_bytes_free());
+//------------------------------------------------------------------------------------------------//
+// Pinned Lines
+//----------------------------------------------//
+// Each pinned line is a child layer of the console layer.  Marking it dirty still redraws the whole window on
+//   Pebble, console layer included, so an update costs a full redraw of the log: it only saves the buffer.
+// Its slot is sized when it's pinned, and slots are stacked again whenever a line is pinned or removed.
+
+// Puts each pinned line in its slot: Lines pinned to the top stack down from the top, lines pinned to the
+//   bottom stack up from the bottom, each edge in the order they were pinned
+static void console_layer_layout_pinned(Layer *console_layer) {
+  console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
+  GRect bounds = layer_get_bounds(console_layer);
+  console_data->pinned_top = console_data->pinned_bottom = 0;
+  for (Layer *pinned_line = console_data->pinned; pinned_line; pinned_line = ((console_pinned_struct*)layer_get_data(pinned_line))->next_pinned) {
+    int16_t height = layer_get_frame(pinned_line).size.h;
+    if (((console_pinned_struct*)layer_get_data(pinned_line))->position == ConsolePinTop) {
+      layer_set_frame(pinned_line, GRect(bounds.origin.x, bounds.origin.y + console_data->pinned_top, bounds.size.w, height));
+      console_data->pinned_top += height;
+    } else {
+      console_data->pinned_bottom += height;
+      layer_set_frame(pinned_line, GRect(bounds.origin.x, bounds.origin.y + bounds.size.h - console_data->pinned_bottom, bounds.size.w, height));
+    }
+  }
+  MARK_DIRTY;  // The log's area has changed
+}
+
+// Modifies Graphics Context: Text Color
+static void console_pinned_update(Layer *pinned_line, GContext *ctx) {
+  console_pinned_struct *pinned_data = (console_pinned_struct*)layer_get_data(pinned_line);
+  console_data_struct *console_data = (console_data_struct*)layer_get_data(pinned_data->console_layer);
+  GRect bounds = layer_get_bounds(pinned_line);
+  TRACE(uint32_t trace_start = trace_now());
+
+  // Render Text (y-3 for the system's text engine, same as the log's lines)
+  #if (console_layer_glyphs)
+  if (pinned_data->font == GFontConsoleGlyphs)
+    console_draw_glyphs(ctx, pinned_line, pinned_data->text, NULL, 0, console_data->text_color, bounds, console_data->alignment, false);
+  else
+  #endif
+  if (pinned_data->text[0] && console_data->text_color.argb!=GColorClear.argb) {  // Pebble renders clear text as black
+    graphics_context_set_text_color(ctx, console_data->text_color);
+    graphics_draw_text(ctx, pinned_data->text, pinned_data->font, GRect(bounds.origin.x, bounds.origin.y - 3, bounds.size.w, bounds.size.h), GTextOverflowModeTrailingEllipsis, console_data->alignment, NULL);
+  }
+  TRACE(trace_redraw(pinned_line, trace_start, 1));
+}
+
+//----------------------------------------------//
+
+Layer* console_layer_add_pinned(Layer *console_layer, ConsolePinPosition position, int size) {
+  console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
+  if (size < 1) size = 1;  // Room for the 0 at least
+  GRect bounds = layer_get_bounds(console_layer);
+  int16_t height = console_text_height(" ", console_data->font, bounds.size.w, console_data->alignment);
+
+  Layer *pinned_line = layer_create_with_data(GRect(0, 0, bounds.size.w, height), sizeof(console_pinned_struct) + size);
+  if (pinned_line) {
+    console_pinned_struct *pinned_data = (console_pinned_struct*)layer_get_data(pinned_line);
+    *pinned_data = (console_pinned_struct){
+      .console_layer = console_layer,
+      .position      = position == ConsolePinBottom ? ConsolePinBottom : ConsolePinTop,
+      .font          = console_data->font,
+      .size          = size,
+      .text          = (char*)(pinned_data + 1)  // Text is allocated just after the struct
+    };
+    pinned_data->text[0] = 0;
+    TRACE(trace_add_pinned(pinned_line, console_layer, pinned_data->position, size));
+
+    // Goes last in the list, so lines pinned to the same edge stay in the order they were pinned
+    Layer **last = &console_data->pinned;
+    while (*last) last = &((console_pinned_struct*)layer_get_data(*last))->next_pinned;
+    *last = pinned_line;
+
+    layer_set_clips(pinned_line, true);
+    layer_set_update_proc(pinned_line, console_pinned_update);
+    layer_add_child(console_layer, pinned_line);
+    console_layer_layout_pinned(console_layer);
+  }
+  return pinned_line;
+}
+
+void console_layer_update_pinned(Layer *pinned_line, const char *text) {
+  console_pinned_struct *pinned_data = (console_pinned_struct*)layer_get_data(pinned_line);
+  if (!text) text = "";
+
+  // Cut short to fit, between UTF-8 characters
+  size_t length = 0;
+  while (text[length] && length + 1 < pinned_data->size) length++;
+  if (text[length])
+    while (length && (text[length] & 0xC0) == 0x80) length--;  // Back up to the start of the character cut in two
+  TRACE(trace_record(ConsoleTraceUpdatePinned, pinned_line, 2));
+  TRACE(trace_u16(length));
+
+  if (pinned_data->text[length] == 0 && strncmp(pinned_data->text, text, length) == 0) return;  // Unchanged: Nothing to redraw
+  memcpy(pinned_data->text, text, length);
+  pinned_data->text[length] = 0;
+  #if (dirty_console_layer_automatically)
+  layer_mark_dirty(pinned_line);  // The system redraws the whole window, log and all
+  #endif
+}
+
+void console_layer_remove_pinned(Layer *pinned_line) {
+  Layer *console_layer = ((console_pinned_struct*)layer_get_data(pinned_line))->console_layer;
+  console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
+  TRACE(trace_destroy(pinned_line));
+  for (Layer **layer = &console_data->pinned; *layer; layer = &((console_pinned_struct*)layer_get_data(*layer))->next_pinned)
+    if (*layer == pinned_line) {
+      *layer = ((console_pinned_struct*)layer_get_data(pinned_line))->next_pinned;
+      break;
+    }
+  layer_remove_from_parent(pinned_line);
+  layer_destroy(pinned_line);
+  console_layer_layout_pinned(console_layer);
+}
+
+
+//------------------------------------------------------------------------------------------------//
+// Export
+//----------------------------------------------//
+// Chunks are counted by ring, like a log's stamp: The newest chunk of a ring is number written-1, the one before it
+//   written-2, and so on.  An export remembers how many of each ring it's sent, and each batch walks back from the
+//   newest chunk to find what's next.  A chunk written over before it was sent is counted as skipped.
+#if (console_layer_phone_export)
+#define EXPORT_MAX_CHUNKS 16         // Most chunks of each ring found in one walk (a batch walks again for more)
+#define EXPORT_RETRIES     6         // Times a batch is sent again before giving up
+#define EXPORT_RETRY_MS  250         // Wait before sending a batch again, doubled each time
+
+static struct {
+  ConsoleLog *log;                   // Log being exported (NULL = none, or it's been destroyed and the batch being sent is the last)
+  uint8_t     number;                // Export number, so the phone can tell a new export from a batch sent again
+  uint16_t    batch;                 // Batch number, from 1
+  uint32_t    sent[2];               // Chunks of each ring sent so far
+  size_t      offset;                // Characters of the next chunk already sent (it didn't fit in the last batch)
+  uint8_t     offset_ring;           // Ring the next chunk is in, if offset isn't 0
+  uint32_t    next_sent[2];          // What sent, offset and offset_ring will be once the batch is acknowledged
+  size_t      next_offset;
+  uint8_t     next_offset_ring;
+  uint16_t    skipped;               // Chunks written over before they could be sent, not yet reported to the phone
+  bool        report_skipped;        // Whether the batch reports them
+  bool        done;                  // Whether the batch has everything left
+  uint8_t    *text;                  // The batch's text, kept until it's acknowledged so it can be sent again as it was
+  uint16_t    capacity;              // Room in text
+  uint16_t    length;                // Bytes of text in the batch (the batch is built once text is allocated)
+  bool        built;                 // Whether the batch has been built
+  bool        waiting;               // Whether a batch has been sent and neither acknowledged nor failed yet
+  uint8_t     retries;
+  AppTimer   *timer;
+  AppMessageOutboxSent   app_sent;   // The app's outbox handlers, given back once the export's done
+  AppMessageOutboxFailed app_failed;
+} export_state;
+
+// Finds the oldest chunks in the ring that haven't been sent (up to EXPORT_MAX_CHUNKS), oldest first.
+// Returns how many were found.  *first is set to the number of the oldest (any from sent up to it have been
+//   written over), and *more to whether there are newer ones that weren't found.
+static uint8_t console_export_find(console_ring *ring, bool stamped, uint32_t written, uint32_t sent, intptr_t *found, uint32_t *first, bool *more) {
+  intptr_t newest[EXPORT_MAX_CHUNKS];  // The last chunks walked past, oldest last (round and round)
+  size_t count = 0;
+  uint32_t number = written;
+  uintptr_t oldest = console_ring_oldest(ring, stamped);  // Any older have been written over (see Valid Chunks)
+  intptr_t cursor = ring->pos + 1;  // Get past the EOF 0
+  while (number != sent && cursor - ring->pos <= oldest) {
+    intptr_t start = cursor;
+    cursor = console_ring_skip_settings(ring, cursor, stamped);
+    while (ring->buffer[++cursor % ring->buffer_size]);  // Get to its EndOfString
+    newest[count++ % EXPORT_MAX_CHUNKS] = start;
+    number--;
+    cursor += 1 + CHUNK_LENGTH;
+  }
+  uint8_t found_count = count < EXPORT_MAX_CHUNKS ? count : EXPORT_MAX_CHUNKS;
+  for (uint8_t i = 0; i < found_count; i++)
+    found[i] = newest[(count - 1 - i) % EXPORT_MAX_CHUNKS];
+  *first = number;
+  *more  = count > EXPORT_MAX_CHUNKS;
+  return found_count;
+}
+
+// Fills the batch with the oldest text that hasn't been sent, in the order it was written
+static void console_export_build(void) {
+  ConsoleLog *console_log = export_state.log;
+  console_ring *rings[2] = {&console_log->ring, &console_log->priority};
+  uint32_t written[2] = {console_log->stamp, console_log->priority_count};
+  intptr_t found[2][EXPORT_MAX_CHUNKS];
+  uint8_t  count[2], used[2] = {0, 0};
+  uint32_t first[2];
+  bool     more[2];
+
+  for (uint8_t r = 0; r < 2; r++) {
+    count[r] = console_export_find(rings[r], r == 1, written[r], export_state.sent[r], found[r], &first[r], &more[r]);
+    export_state.skipped += first[r] - export_state.sent[r];
+    export_state.next_sent[r] = first[r];
+  }
+  // If the chunk that didn't fit in the last batch has been written over, the rest of it is gone too:
+  //   It's ended where it got to (by reporting skipped chunks, if there are any others, or else by a 0).
+  //   The phone has its start, so it isn't counted as skipped.
+  size_t offset = export_state.offset;
+  export_state.length = 0;
+  if (offset && first[export_state.offset_ring] != export_state.sent[export_state.offset_ring]) {
+    if (!--export_state.skipped) export_state.text[export_state.length++] = 0;
+    offset = 0;
+  }
+  // Reporting skipped chunks ends the text being carried on, so it's finished first, alone, and they're reported next batch
+  bool finish_first = offset && export_state.skipped;
+  export_state.report_skipped = export_state.skipped && !offset;
+
+  export_state.next_offset = 0;
+  export_state.done = false;
+  while (true) {
+    // A ring whose found chunks have all gone in, but has newer ones, finds the next of them
+    for (uint8_t r = 0; r < 2; r++)
+      if (used[r] == count[r] && more[r]) {
+        count[r] = console_export_find(rings[r], r == 1, written[r], export_state.next_sent[r], found[r], &first[r], &more[r]);
+        used[r]  = 0;
+      }
+    // Next chunk: The older of the next normal and next priority chunks.  A priority chunk goes before
+    //   the normal chunks written after it.
+    bool normal = used[0] < count[0], high = used[1] < count[1];
+    if (!normal && !high) {
+      export_state.done = true;
+      break;
+    }
+    uint8_t r = high && (!normal || (int32_t)(console_ring_stamp(rings[1], found[1][used[1]]) - export_state.next_sent[0]) <= 0);
+
+    // Copy its text, skipping what's already been sent, and end it with 0 if there's room
+    console_reader reader = {.ring = rings[r], .cursor = console_ring_skip_settings(rings[r], found[r][used[r]], r == 1), .packed = console_log->packed};
+    size_t characters = 0;
+    char c;
+    while ((c = console_read_char(&reader)) && export_state.length < export_state.capacity)
+      if (characters++ >= offset)
+        export_state.text[export_state.length++] = c;
+    if (c || export_state.length == export_state.capacity) {
+      // Batch is full: Carry on from here in the next one
+      export_state.next_offset = characters > offset ? characters : offset;
+      export_state.next_offset_ring = r;
+      break;
+    }
+    export_state.text[export_state.length++] = 0;
+    export_state.next_sent[r]++;
+    used[r]++;
+    offset = 0;
+    if (finish_first) break;
   }
 }
 
+// Gives back the app's outbox handlers and frees the batch
+static void console_export_finish(bool done) {
+  if (export_state.timer) app_timer_cancel(export_state.timer);
+  app_message_register_outbox_sent(export_state.app_sent);
+  app_message_register_outbox_failed(export_state.app_failed);
+  free(export_state.text);
+  export_state.log     = NULL;
+  export_state.text    = NULL;
+  export_state.timer   = NULL;
+  export_state.waiting = false;
+  if (!done)
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Console export stopped before it was done");
+}
+
+static void console_export_send(void);
+
+static void console_export_retry(void *data) {
+  (void)data;
+  export_state.timer = NULL;
+  console_export_send();
+}
+
+// Tries the batch again later, waiting longer every time, until it's been tried too many times
+static void console_export_retry_later(void) {
+  if (export_state.retries >= EXPORT_RETRIES)
+    console_export_finish(false);
+  else
+    export_state.timer = app_timer_register(EXPORT_RETRY_MS << export_state.retries++, console_export_retry, NULL);
+}
+
+// Sends the batch (building it first, if it hasn't been)
+static void console_export_send(void) {
+  DictionaryIterator *iterator;
+  if (app_message_outbox_begin(&iterator) != APP_MSG_OK) {
+    console_export_retry_later();  // Outbox is busy (or AppMessage isn't open)
+    return;
+  }
+
+  if (!export_state.text && !export_state.built) {
+    // First batch: Make room for as much text as fits in the outbox alongside the other values
+    size_t room  = (uint8_t*)iterator->end - (uint8_t*)iterator->dictionary;
+    size_t other = dict_calc_buffer_size(5, sizeof(uint8_t), sizeof(uint16_t), 0, sizeof(uint16_t), sizeof(uint8_t));
+    size_t capacity = room > other ? room - other : 0;
+    export_state.capacity = capacity > UINT16_MAX ? UINT16_MAX : capacity;
+    export_state.text = export_state.capacity ? malloc(export_state.capacity) : NULL;
+    if (!export_state.text) {
+      // Can't send any text: Send a last batch without any, so the phone knows it's over
+      APP_LOG(APP_LOG_LEVEL_WARNING, "Unable to export console text: Out of space (%d bytes needed, %d heap bytes free)", (int)capacity, (int)heap_bytes_free());
+      export_state.capacity = 0;
+      export_state.length   = 0;
+      export_state.report_skipped = false;
+      export_state.done     = true;
+      export_state.built    = true;
+    }
+  }
+  if (!export_state.built) {
+    console_export_build();
+    export_state.built = true;
+  }
+
+  dict_write_uint8 (iterator, CONSOLE_EXPORT_KEY + 0, export_state.number);
+  dict_write_uint16(iterator, CONSOLE_EXPORT_KEY + 1, export_state.batch);
+  if (export_state.length)
+    dict_write_data(iterator, CONSOLE_EXPORT_KEY + 2, export_state.text, export_state.length);
+  if (export_state.report_skipped)
+    dict_write_uint16(iterator, CONSOLE_EXPORT_KEY + 3, export_state.skipped);
+  if (export_state.done)
+    dict_write_uint8 (iterator, CONSOLE_EXPORT_KEY + 4, 1);
+  if (app_message_outbox_send() != APP_MSG_OK) {
+    console_export_retry_later();
+    return;
+  }
+  export_state.waiting = true;
+}
+
+static void console_export_outbox_sent(DictionaryIterator *iterator, void *context) {
+  if (!export_state.waiting) {
+    // Not the export's batch: Pass it on
+    if (export_state.app_sent) export_state.app_sent(iterator, context);
+    return;
+  }
+  export_state.waiting = false;
+  export_state.retries = 0;
+  if (export_state.done || !export_state.log) {
+    console_export_finish(export_state.done);
+    return;
+  }
+  // Move on past what the phone now has
+  if (export_state.report_skipped) export_state.skipped = 0;
+  memcpy(export_state.sent, export_state.next_sent, sizeof(export_state.sent));
+  export_state.offset      = export_state.next_offset;
+  export_state.offset_ring = export_state.next_offset_ring;
+  export_state.batch++;
+  export_state.built = false;
+  console_export_send();
+}
+
+static void console_export_outbox_failed(DictionaryIterator *iterator, AppMessageResult reason, void *context) {
+  if (!export_state.waiting) {
+    if (export_state.app_failed) export_state.app_failed(iterator, reason, context);
+    return;
+  }
+  export_state.waiting = false;
+  if (!export_state.log)
+    console_export_finish(false);
+  else
+    console_export_retry_later();
+}
+
+// Stops exporting console_log (it's being destroyed).  A batch that's been sent is left to finish.
+static void console_export_stop(ConsoleLog *console_log) {
+  if (export_state.log != console_log) return;
+  export_state.log = NULL;
+  if (!export_state.waiting) console_export_finish(false);
+}
+
+//----------------------------------------------//
+
+bool console_export_running(void) {
+  return export_state.log || export_state.waiting;
+}
+
+bool console_log_export(ConsoleLog *console_log) {
+  if (console_export_running()) return false;
+  TRACE(trace_record(ConsoleTraceExport, console_log, 0));
+
+  // Start from the oldest text still in the log
+  console_ring *rings[2] = {&console_log->ring, &console_log->priority};
+  uint32_t written[2] = {console_log->stamp, console_log->priority_count};
+  intptr_t found[EXPORT_MAX_CHUNKS];
+  bool more;
+  for (uint8_t r = 0; r < 2; r++)
+    console_export_find(rings[r], r == 1, written[r], written[r] + 1, found, &export_state.sent[r], &more);
+
+  export_state.log     = console_log;
+  export_state.number++;
+  export_state.batch   = 1;
+  export_state.offset  = 0;
+  export_state.skipped = 0;
+  export_state.built   = false;
+  export_state.retries = 0;
+  export_state.app_sent   = app_message_register_outbox_sent(console_export_outbox_sent);
+  export_state.app_failed = app_message_register_outbox_failed(console_export_outbox_failed);
+  console_export_send();
+  return true;
+}
+
+bool console_layer_export(Layer *console_layer) {
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  return console_log && console_log_export(console_log);
+}
+#endif
 
 
 
@@ -358,19 +2026,28 @@ static void console_layer_update(Layer *console_layer, GContext *ctx) {
 // Create Layer
 //----------------------------------------------//
 
-Layer* console_layer_create_with_buffer_size(GRect frame, int buffer_size) {
+// Creates a layer showing console_log, or if console_log is NULL, with its own log with buffer_size byte buffer
+static Layer* console_layer_create_internal(GRect frame, ConsoleLog *console_log, int buffer_size) {
   Layer *console_layer;
-  size_t data_size = sizeof (console_data_struct) + buffer_size;
+  // Layers showing another log don't need own_log or a buffer, so leave them off the end of the struct
+  size_t data_size = console_log ? offsetof(console_data_struct, own_log) : sizeof (console_data_struct) + buffer_size;
 
   if ((console_layer = layer_create_with_data(frame, data_size))) {
     console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
-    // Point buffer to memory allocated just after the struct.  Assumes buffer is the last type inside struct.
-    // Sure, this could be malloc'd separately instead of complicated pointer math, but hey, this works.
-    console_data->buffer = (char*)(&(console_data->buffer) + sizeof(console_data->buffer));
-    console_data->buffer_size = buffer_size;
+    console_data->owns_log = !console_log;
+    console_data->pinned = NULL;
+    console_data->pinned_top = console_data->pinned_bottom = 0;
+    TRACE(trace_create(console_layer, frame, console_data->owns_log ? buffer_size : 0, console_data->owns_log ? &console_data->own_log : console_log));
+    if (console_data->owns_log) {
+      // Point buffer to memory allocated just after the struct.
+      // Sure, this could be malloc'd separately instead of pointer math, but hey, this works.
+      console_log = &console_data->own_log;
+      console_log_init(console_log, (char*)(console_data + 1), buffer_size);
+      console_log->owned = true;
+    }
 
     layer_set_clips(console_layer, true);
-    console_layer_clear(console_layer);
+    console_layer_set_log(console_layer, console_log);
     console_layer_set_style(console_layer, GColorBlack, GColorClear, fonts_get_system_font(FONT_KEY_GOTHIC_14), GTextAlignmentLeft, true);
     layer_set_update_proc(console_layer, console_layer_update);
   }
@@ -379,10 +2056,37 @@ Layer* console_layer_create_with_buffer_size(GRect frame, int buffer_size) {
 
 //----------------------------------------------//
 
+Layer* console_layer_create_with_buffer_size(GRect frame, int buffer_size) {
+  return console_layer_create_internal(frame, NULL, buffer_size);
+}
+
 Layer* console_layer_create(GRect frame) {
   return console_layer_create_with_buffer_size(frame, DEFAULT_BUFFER_SIZE);
 }
 
+Layer* console_layer_create_with_log(GRect frame, ConsoleLog *console_log) {
+  if (!console_log) return NULL;
+  return console_layer_create_internal(frame, console_log, 0);
+}
+
+//----------------------------------------------//
+
+void console_layer_destroy(Layer *console_layer) {
+  console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
+  console_layer_set_log(console_layer, NULL);
+  while (console_data->pinned)
+    console_layer_remove_pinned(console_data->pinned);
+  TRACE(trace_destroy(console_layer));
+  if (console_data->owns_log) {
+    TRACE(trace_destroy(&console_data->own_log));
+    #if (console_layer_phone_export)
+    console_export_stop(&console_data->own_log);
+    #endif
+    console_log_remove_all_layers(&console_data->own_log);  // Its buffer is about to go
+  }
+  layer_destroy(console_layer);
+}
+
 
 
 //------------------------------------------------------------------------------------------------//
@@ -394,14 +2098,14 @@ Layer* console_layer_create(GRect frame) {
 /*
 // Log the console layer buffer's raw data: for debugging
 void log_buffer(Layer *console_layer) {
-  console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
-  printf("Head/Tail Separator Position: %d", (int)console_data->pos);
-  //for(int i=console_data->pos; i<console_data->buffer_size; i++)  // Log from current (EOF head/tail) position to the end of the buffer
-  for(int i=0; i<console_data->buffer_size; i++)                    // Log the whole buffer
-    if (console_data->buffer[i]<=127 && console_data->buffer[i]>=32)
-      printf("buffer[%d] = %d (%x) '%c'", i, console_data->buffer[i], console_data->buffer[i], console_data->buffer[i]);
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  printf("Head/Tail Separator Position: %d", (int)console_log->ring.pos);
+  //for(int i=console_log->ring.pos; i<console_log->ring.buffer_size; i++)  // Log from current (EOF head/tail) position to the end of the buffer
+  for(int i=0; i<console_log->ring.buffer_size; i++)                    // Log the whole buffer
+    if (console_log->ring.buffer[i]<=127 && console_log->ring.buffer[i]>=32)
+      printf("buffer[%d] = %d (%x) '%c'", i, console_log->ring.buffer[i], console_log->ring.buffer[i], console_log->ring.buffer[i]);
     else
-      printf("buffer[%d] = %d (%x)", i, console_data->buffer[i], console_data->buffer[i]);
+      printf("buffer[%d] = %d (%x)", i, console_log->ring.buffer[i], console_log->ring.buffer[i]);
 }
 */
 
@@ -414,14 +2118,18 @@ void log_buffer(Layer *console_layer) {
 // Extracts all strings from the console_layer and logs them via printf()
 // Currently logs everything from most newest to oldest (with newest at the top of the output -- opposite of the console_layer)
 void console_layer_log_contents(Layer *console_layer) {
-  console_data_struct *console_data = (console_data_struct*)layer_get_data(console_layer);
-  char *text = malloc(console_data->buffer_size + 1); // allocate on heap
+  ConsoleLog *console_log = console_layer_get_log(console_layer);
+  char *text = malloc(console_log->ring.buffer_size + 1); // allocate on heap
   if (text) {  // verify heap allocation was successful
     uint8_t settings;
-    intptr_t cursor = console_data->pos + 1;  // Get past the EOF 0
+    intptr_t cursor = console_log->ring.pos + 1;  // Get past the EOF 0
+    uintptr_t oldest = console_ring_oldest(&console_log->ring, false);
+
+    // While not past the oldest whole chunk (also copy its first byte to settings)
+    while (cursor - console_log->ring.pos <= oldest && (settings = console_log->ring.buffer[cursor % console_log->ring.buffer_size])) {
+      // If extended settings are specified, copy from buffer
+      uint8_t extended = (settings&EXTENDED_BITS) == EXTENDED_BITS ? console_log->ring.buffer[++cursor % console_log->ring.buffer_size] : 0;
 
-    // While text is within visible bounds && not at EOF (also, if not EOF, copy byte to settings)
-    while ((settings = console_data->buffer[cursor % console_data->buffer_size])) {
       // If background color is specified in settings, copy from buffer
       if (settings&BACKGROUND_COLOR_BIT)
         ++cursor;
@@ -435,24 +2143,26 @@ void console_layer_log_contents(Layer *console_layer) {
         for (uintptr_t i=0; i<sizeof(GFont); i++)
           ++cursor;
 
+      // If a span table is specified in extended settings, skip it (2 bytes per span)
+      if (extended&SPANS_BIT) {
+        uint8_t span_count = console_log->ring.buffer[++cursor % console_log->ring.buffer_size];
+        cursor += 2 * span_count;
+      }
+
 
       // Copy the 0-terminated string into a temp buffer (because pebble's text functions can't wrap around end of buffer)
       intptr_t i = -1;
       do {
-        if (i < (intptr_t)(console_data->buffer_size)) i++;     // Stop it from maxing out
-        text[i] = console_data->buffer[++cursor % console_data->buffer_size];
+        if (i < (intptr_t)(console_log->ring.buffer_size)) i++;     // Stop it from maxing out
+        text[i] = console_log->ring.buffer[++cursor % console_log->ring.buffer_size];
       } while (text[i]);
 
-      // If we've not gone beyond the size of the buffer, then the data should be valid
-      // If we HAVE gone beyond the buffer_size, buffer[cursor%size] is pointing at 0, exiting the while loop
-      if (cursor - console_data->pos < console_data->buffer_size) {
-        cursor++;  // Get past the string terminating 0 so the while can loop (unless we're now at the EOF 0)
-        printf("%s", text);
-      } // END if data valid
+      cursor += 1 + CHUNK_LENGTH;  // Get past the string terminating 0 (and its length byte) so the while can loop
+      printf("%s", text);
     } // END While
     free(text);
   } else {
-    APP_LOG(APP_LOG_LEVEL_WARNING, "Unable to display console_layer text: Out of space (%d bytes needed, %d heap bytes free)", (int)console_data->buffer_size + 1, (int)heap_bytes_free());
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Unable to display console_layer text: Out of space (%d bytes needed, %d heap bytes free)", (int)console_log->ring.buffer_size + 1, (int)heap_bytes_free());
   }
 }
 */
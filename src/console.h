@@ -23,6 +23,82 @@
 #define WordWrapInherit        2
 
 
+//------------------------------------------------------------------------------------------------//
+// Inline Styles
+//------------------------------------------------------------------------------------------------//
+// Written text can change color partway through using ANSI SGR escape sequences:
+//   console_layer_write_text(my_console_layer, "Status: " CONSOLE_RED "FAIL" CONSOLE_RESET);
+// Sequences are parsed once when written and stored as a small span table with the text.  Drawing still
+//   measures and draws each span on its own, so a line with inline styles costs more to draw than a plain one.
+// Text with inline styles is always displayed on one line (as if Word Wrap is off).
+// A text has at most 16 spans (one per color change, and one more per 255 bytes in the same color).  Any
+//   color changes after that are ignored: the rest of the text stays in the 16th span's color.
+// Supported: 30-37 and 90-97 (text colors), 39 and 0 (back to the text's normal color)
+
+#define CONSOLE_BLACK          "\x1b[30m"
+#define CONSOLE_RED            "\x1b[31m"
+#define CONSOLE_GREEN          "\x1b[32m"
+#define CONSOLE_YELLOW         "\x1b[33m"
+#define CONSOLE_BLUE           "\x1b[34m"
+#define CONSOLE_MAGENTA        "\x1b[35m"
+#define CONSOLE_CYAN           "\x1b[36m"
+#define CONSOLE_WHITE          "\x1b[97m"
+#define CONSOLE_RESET          "\x1b[0m"
+
+
+//------------------------------------------------------------------------------------------------//
+// Feature Profile
+//------------------------------------------------------------------------------------------------//
+// Strips features your app doesn't use out of the library at compile time.  Smaller profiles skip
+//   decoding them when drawing and don't save their settings in the buffer.
+//   CONSOLE_PROFILE_FULL:       Everything
+//   CONSOLE_PROFILE_STYLED_LOG: Per-text text colors and inline styles.  Font, background color,
+//                               alignment and word wrap always come from the console_layer.
+//   CONSOLE_PROFILE_PLAIN_LOG:  All text uses the console_layer's style.  Inline styles aren't parsed.
+// console_layer_write_text_styled() ignores any style the profile doesn't support.
+
+#define CONSOLE_PROFILE_FULL        0
+#define CONSOLE_PROFILE_STYLED_LOG  1
+#define CONSOLE_PROFILE_PLAIN_LOG   2
+
+#define console_layer_profile CONSOLE_PROFILE_FULL
+
+
+//------------------------------------------------------------------------------------------------//
+// Built-in Glyphs
+//------------------------------------------------------------------------------------------------//
+// Set to true to include a tiny built-in font, GFontConsoleGlyphs, which is drawn straight into the frame
+//   buffer instead of through the system's text engine: much quicker during a flood of log lines.  It's
+//   5x7 pixel glyphs 6 pixels apart in 9 pixel lines, about the size of GOTHIC_09, and it's used like any
+//   other GFont (e.g. console_layer_set_font(my_console_layer, GFontConsoleGlyphs)).
+// Only printable ASCII has glyphs (others are drawn as a box).  Word wrap breaks at the last space that
+//   fits.  Text is clipped to the console layer, but not to the layers it's inside.  On black and white
+//   screens, light colors are drawn white and the rest black.
+// Set to false to leave it (and its 485 byte glyph atlas) out if your app doesn't use it.
+
+#define console_layer_glyphs false
+
+#if (console_layer_glyphs)
+extern const uint8_t console_glyph_atlas[][5];
+#define GFontConsoleGlyphs ((GFont)(void*)console_glyph_atlas)
+#endif
+
+
+//------------------------------------------------------------------------------------------------//
+// Chunk Lengths
+//------------------------------------------------------------------------------------------------//
+// Set to true to end each text in the buffer with a length byte.  When new text writes over the oldest
+//   text, the log then steps back to the next oldest straight away (checking it starts where the length
+//   says), so drawing and exporting never have to look for where the text that's still whole ends.
+//   Texts over 255 bytes don't fit it, so the log walks again once one of them is next to go.
+// Leave it false to save that byte per text.  The log then finds where it ends by walking every text in
+//   its buffer, newest to oldest, the first time it's drawn or exported after each write that wrote over
+//   old text.  That walk takes time in proportion to the buffer size, on top of drawing (which only reads
+//   the texts it shows), so set this to true for a large buffer that's written over between redraws.
+
+#define console_layer_chunk_lengths false
+
+
 //------------------------------------------------------------------------------------------------//
 // Dirty Automatically
 //------------------------------------------------------------------------------------------------//
@@ -32,14 +108,91 @@
 #define dirty_console_layer_automatically true
 
 
+//------------------------------------------------------------------------------------------------//
+// Trace
+//------------------------------------------------------------------------------------------------//
+// Set to true to record every console layer call and redraw (with timestamps, arguments and text
+//   lengths, but not the text itself) into a compact binary trace.  The trace is logged as hex
+//   lines starting with "CONSOLE_TRACE" whenever it fills up or console_trace_dump() is called.
+//   Capture them with "pebble logs" and profile the session on a computer with tools/replay.
+
+#define console_layer_trace false
+
+// Trace record types.  Each record is: type (1 byte), milliseconds since the last record
+//   (2 bytes, little endian), layer id (1 byte), then the type's arguments:
+typedef enum {
+  ConsoleTraceCreate = 1,               // buffer size (2), frame x, y, w, h (2 each), log id (1): its own log,
+                                        //   or if buffer size is 0, the log it was created showing
+  ConsoleTraceClear,                    // -
+  ConsoleTraceSetStyle,                 // text color, background color, font id, alignment, word wrap (1 each)
+  ConsoleTraceSetBackgroundColor,       // background color (1)
+  ConsoleTraceSetTextColor,             // text color (1)
+  ConsoleTraceSetAlignment,             // alignment (1)
+  ConsoleTraceSetWordWrap,              // word wrap (1)
+  ConsoleTraceSetFont,                  // font id (1)
+  ConsoleTraceWrite,                    // text color, background color, font id, alignment, word wrap (1 each), text length (2)
+  ConsoleTraceRedraw,                   // milliseconds spent drawing (2), rows drawn (1)
+  ConsoleTraceCreateLog,                // buffer size (2)
+  ConsoleTraceSetLog,                   // log id (1)
+  ConsoleTraceDestroy,                  // - (layer or log)
+  ConsoleTraceWriteLines,               // text color, background color, font id, alignment, word wrap (1 each), line count (2), total text length (2)
+  ConsoleTraceWritePriority,            // (same as Write, for high priority text)
+  ConsoleTraceReservePriority,          // reserve size (2)
+  ConsoleTraceSetPacked,                // packed (1)
+  ConsoleTraceExport,                   // -
+  ConsoleTraceAddPinned,                // console layer id (1), position (1), size (2)
+  ConsoleTraceUpdatePinned,             // text length (2)
+  ConsoleTraceFont,                     // font id (1), line height (1), average character width (1): recorded just
+                                        //   before the first record using a new font id (its own id byte is 255)
+} ConsoleTraceType;
+// Layer, log and pinned line ids share one numbering: Ids are given out in order of creation and reused once destroyed
+// Clear, Write, Write Lines, Write Priority, Reserve Priority, Set Packed and Export records have the id of the log
+// Add Pinned and Update Pinned records have the id of the pinned line, and so do Redraw and Destroy records for it
+// Font ids: 0 = GFontInherit, 1-15 = fonts in the order they were first seen, 254 = GFontConsoleGlyphs, 255 = too many fonts
+
+#if (console_layer_trace)
+void console_trace_dump(void);          // Logs the trace recorded so far, then starts a new one
+#endif
+
+
+//------------------------------------------------------------------------------------------------//
+// Export
+//------------------------------------------------------------------------------------------------//
+// Set to true to be able to send a log's text to the phone over AppMessage (see Export below).
+// Set to false to leave it out if your app doesn't use it.
+
+#define console_layer_phone_export false
+
+
+//------------------------------------------------------------------------------------------------//
+// Console Logs
+//------------------------------------------------------------------------------------------------//
+// A console log is a text buffer without a layer.  It can be written to at any time, even before
+//   any window is loaded, without any drawing.  Console layers show it by attaching to it, and it
+//   keeps its text when they're destroyed.  More than one layer can show the same log.
+// Every console layer created with a buffer size has a log of its own, destroyed along with it.
+
+typedef struct ConsoleLog ConsoleLog;
+
+ConsoleLog* console_log_create (int buffer_size);
+void        console_log_destroy(ConsoleLog *console_log);    // Detaches any layers still showing it.  Only for logs from
+                                                             //   console_log_create: a layer's own log is left alone
+
+
 //------------------------------------------------------------------------------------------------//
 // Create and Destroy Layers
 //------------------------------------------------------------------------------------------------//
 Layer* console_layer_create_with_buffer_size(GRect frame, int buffer_size);
 Layer* console_layer_create                 (GRect frame);   // Creates layer with 500 byte buffer
+Layer* console_layer_create_with_log        (GRect frame, ConsoleLog *console_log);   // Shows console_log, no buffer of its own
 
-// You can just use the standard layer_destroy to destroy a console_layer.  Adding for consistency
-#define console_layer_destroy(console_layer) layer_destroy(console_layer)
+// Use console_layer_destroy if the layer shows a separate log, other layers show its log, or it has pinned lines.
+// Otherwise, the standard layer_destroy works too.
+void   console_layer_destroy                (Layer *console_layer);
+
+// Attach a layer to a log to show it instead (NULL to show nothing).  Nothing is copied.
+void        console_layer_set_log(Layer *console_layer, ConsoleLog *console_log);
+ConsoleLog* console_layer_get_log(Layer *console_layer);  // A layer's own log goes with the layer: don't destroy it
 
 //------------------------------------------------------------------------------------------------//
 // Gets
@@ -72,6 +225,7 @@ void console_layer_set_style           (Layer *console_layer,
 // Write Text
 // Note: The function deep copies the source text into the console_layer's buffer
 //       so it can be from a temporary source.
+// Writing to a console_layer writes to the log it shows, so every layer showing that log shows it.
 //------------------------------------------------------------------------------------------------//
 void console_layer_clear            (Layer *console_layer);
 void console_layer_write_text       (Layer *console_layer, char *text);
@@ -83,3 +237,146 @@ void console_layer_write_text_styled(Layer *console_layer,
                                      GFont font,
                                      GTextAlignment alignment,
                                      int word_wrap);
+
+// Write many lines at once, each as its own text with the same style.  Faster than writing them one by one:
+//   The style is worked out once, each line is copied in one go, and the layer is marked dirty once.
+// Text too big for the whole buffer is cut short (between UTF-8 characters), here and when writing one text.
+void console_layer_write_lines(Layer *console_layer,
+                               const char **lines,
+                               size_t count,
+                               GColor text_color,
+                               GColor background_color,
+                               GFont font,
+                               GTextAlignment alignment,
+                               int word_wrap);
+
+// Same as console_layer_write_lines, but with the lines split out of text at each \n (a \n at the very end is ignored)
+void console_layer_write_split(Layer *console_layer,
+                               const char *text,
+                               GColor text_color,
+                               GColor background_color,
+                               GFont font,
+                               GTextAlignment alignment,
+                               int word_wrap);
+
+void console_log_clear            (ConsoleLog *console_log);
+void console_log_write_text       (ConsoleLog *console_log, char *text);
+
+void console_log_write_text_styled(ConsoleLog *console_log,
+                                   char *text,
+                                   GColor text_color,
+                                   GColor background_color,
+                                   GFont font,
+                                   GTextAlignment alignment,
+                                   int word_wrap);
+
+void console_log_write_lines(ConsoleLog *console_log,
+                             const char **lines,
+                             size_t count,
+                             GColor text_color,
+                             GColor background_color,
+                             GFont font,
+                             GTextAlignment alignment,
+                             int word_wrap);
+
+void console_log_write_split(ConsoleLog *console_log,
+                             const char *text,
+                             GColor text_color,
+                             GColor background_color,
+                             GFont font,
+                             GTextAlignment alignment,
+                             int word_wrap);
+
+
+//------------------------------------------------------------------------------------------------//
+// Priority
+// Normally, text is pushed out of the buffer when it's the oldest, so a flood of debug text can push
+//   out the one error you needed to see.  Reserving part of the buffer for high priority text keeps
+//   it apart: It's only pushed out by newer high priority text.  Normal and high priority text are
+//   still shown together, in the order they were written.
+//------------------------------------------------------------------------------------------------//
+typedef enum {
+  ConsolePriorityNormal,
+  ConsolePriorityHigh,                  // Goes in the reserved part of the buffer (or with normal text if none is reserved)
+} ConsolePriority;
+
+// Reserve reserve_size bytes of the log's buffer for high priority text (0 = no reserve).  Clears the log.
+void console_log_reserve_priority  (ConsoleLog *console_log, int reserve_size);
+void console_layer_reserve_priority(Layer *console_layer, int reserve_size);     // For the log the layer shows
+
+// Same as write_text_styled, with a priority.  Each high priority text costs 4 more bytes.
+void console_log_write_text_priority(ConsoleLog *console_log,
+                                     char *text,
+                                     ConsolePriority priority,
+                                     GColor text_color,
+                                     GColor background_color,
+                                     GFont font,
+                                     GTextAlignment alignment,
+                                     int word_wrap);
+
+void console_layer_write_text_priority(Layer *console_layer,
+                                       char *text,
+                                       ConsolePriority priority,
+                                       GColor text_color,
+                                       GColor background_color,
+                                       GFont font,
+                                       GTextAlignment alignment,
+                                       int word_wrap);
+
+
+//------------------------------------------------------------------------------------------------//
+// Packed Text
+// A packed log stores common characters in 4 or 8 bits instead of 8, so a small buffer holds more
+//   lines: about 1.35-1.4x as many short worded lines, 1.1-1.2x for lines that are mostly numbers.
+// Other characters take 12 bits, but text never takes more than 1 byte over its plain size.  Text is
+//   unpacked only when it's drawn.
+//------------------------------------------------------------------------------------------------//
+void console_log_set_packed  (ConsoleLog *console_log, bool packed);   // Clears the log
+void console_layer_set_packed(Layer *console_layer, bool packed);      // For the log the layer shows
+
+
+//------------------------------------------------------------------------------------------------//
+// Pinned Lines
+// A pinned line stays put above or below the scrolling text, in a one line slot of its own.  It's for
+//   status that changes often ("BT: connected  Bat: 80%"): Updating it rewrites its text in place, so it
+//   takes no room in the log's buffer.  It still costs a full console redraw: Pebble redraws the whole
+//   window when any layer is marked dirty, so the log is measured and drawn again too.  Text that's the
+//   same as before doesn't mark anything dirty.
+// Lines pinned to the same edge stack in the order they're pinned, the first nearest the edge.  The log
+//   is drawn in what's left between them.  Pinned lines use the console layer's text color and alignment,
+//   and its font when pinned (which sizes the slot), so set the layer's frame and font before pinning.
+// Text longer than size - 1 bytes is cut short (between UTF-8 characters), and ends in "..." if too wide.
+// console_layer_destroy removes the layer's pinned lines too (the standard layer_destroy doesn't).
+//------------------------------------------------------------------------------------------------//
+typedef enum {
+  ConsolePinTop,                        // Above the log
+  ConsolePinBottom,                     // Below the log
+} ConsolePinPosition;
+
+Layer* console_layer_add_pinned   (Layer *console_layer, ConsolePinPosition position, int size);  // Returns the pinned line, empty to start
+void   console_layer_update_pinned(Layer *pinned_line, const char *text);
+void   console_layer_remove_pinned(Layer *pinned_line);
+
+
+//------------------------------------------------------------------------------------------------//
+// Export
+// Sends a log's text to the phone, oldest first, in batches as big as the AppMessage outbox.  Open
+//   AppMessage (app_message_open()) first.  Each batch is sent once the phone has acknowledged the
+//   last, and sent again (waiting longer each time) if it fails.  Text written while exporting is
+//   sent too, until the export catches up.  src/js/console_export.js puts the text back together.
+// While exporting, the log's export takes over AppMessage's outbox sent and failed handlers.  It
+//   passes on anything that isn't its own batch, and gives them back once it's done.
+//------------------------------------------------------------------------------------------------//
+#if (console_layer_phone_export)
+// The export uses 5 AppMessage keys from CONSOLE_EXPORT_KEY up.  Change it if your app's keys clash.
+#define CONSOLE_EXPORT_KEY 0x434F4E00
+//   CONSOLE_EXPORT_KEY + 0: Export number (uint8), different for each export
+//   CONSOLE_EXPORT_KEY + 1: Batch number (uint16), from 1.  A batch sent again has the same number.
+//   CONSOLE_EXPORT_KEY + 2: Text (byte array), each text ending in 0.  The last may carry on in the next batch.
+//   CONSOLE_EXPORT_KEY + 3: Skipped (uint16), texts written over before they could be sent (only if any)
+//   CONSOLE_EXPORT_KEY + 4: Done (uint8), in the last batch
+
+bool console_log_export    (ConsoleLog *console_log);   // Returns false if an export is already running
+bool console_layer_export  (Layer *console_layer);      // For the log the layer shows
+bool console_export_running(void);
+#endif
@@ -14,10 +14,11 @@ Write:
     console_layer_write_text(my_console_layer, "Hello\nWorld!");  // Word Wrap must be on for \n
 
 Destroy:
-    layer_destroy(my_console_layer);
+    console_layer_destroy(my_console_layer);
 
 TL;DR Notes:
   You can have more than 1 console layer at the same time, each has a separate text buffer & style.
+  Text can also go into a console log, which has no layer, and be shown by any number of layers later.
   Uses a standard Layer pointer, so most standard Pebble layer functions work.
   You can change the layer style after text is written (doesn't affect console_layer_write_text_styled)
   Layer will automatically dirty after writing, unless you turn that setting off.
@@ -160,7 +161,26 @@ Create the console layer and add it as a child to the window or another layer, j
   In fact, this is exactly how console_layer_write_text() works.
 
 
-3c) Clear the layer of text
+3c) Write with inline colors
+  To color part of a line, put ANSI color escape sequences inside the text.  console.h has some defined:
+    console_layer_write_text(my_console_layer, "Status: " CONSOLE_RED "FAIL" CONSOLE_RESET " (3 of 5)");
+  
+  The escape sequences are read once when the text is written and saved with it as a small table of colored spans.
+  Supported codes are 30-37 and 90-97 (text colors) and 0 or 39 (back to the text's normal color).
+  Text with inline colors is always displayed on one line, as if word wrap is off.
+
+
+3d) Write many lines at once
+  Write lots of lines with one call, from an array of strings or split out of one string at each \n:
+    const char *lines[] = {"Battery: 80%", "Bluetooth: Connected", "Free heap: 12000"};
+    console_layer_write_lines(my_console_layer, lines, 3, GColorInherit, GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit);
+    console_layer_write_split(my_console_layer, "Battery: 80%\nBluetooth: Connected", GColorInherit, GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit);
+
+  Each line is saved as if written on its own, but the style is worked out once and the layer marked dirty once.
+  Text too big for the whole buffer is cut short to fit (between UTF-8 characters).
+
+
+3e) Clear the layer of text
 
 You can clear your layer using the function:
   console_layer_clear(my_console_layer);
@@ -188,10 +208,10 @@ This will clear the text from the layer and any specially formatted lines, but l
 
 
 5) Destroy the layer
-  Once you are done with the layer, you can destroy it with the standard Pebble layer_destroy function:
-    layer_destroy(my_console_layer);
+  Once you are done with the layer, destroy it:
+    console_layer_destroy(my_console_layer);
   This will free up the space on the heap taken by the the layer struct and its text buffer.
-  You can also call console_layer_destroy(my_console_layer), but this is just a macro for the standard layer_destroy function
+  If no other layer shows its log (and it doesn't show a separate log, see 9), layer_destroy does the same thing.
 
 
 
@@ -204,6 +224,117 @@ most standard Pebble layer functions with your console layer including (but not
 
 
 
+7) Optional: Strip unused features
+  If your app doesn't use some of the styling features, you can strip them out at compile time to make
+  the library smaller and drawing faster.  In the console.h file is a line that sets the feature profile:
+
+    #define console_layer_profile CONSOLE_PROFILE_FULL
+
+  CONSOLE_PROFILE_FULL:       Everything (the default)
+  CONSOLE_PROFILE_STYLED_LOG: Text can have its own text color and inline colors.  Everything else comes from the layer.
+  CONSOLE_PROFILE_PLAIN_LOG:  All text uses the layer's style.  Inline color escape sequences aren't parsed.
+  console_layer_write_text_styled() still works, but ignores any settings the profile doesn't support.
+
+
+
+
+8) Optional: Profile a real session
+  Set console_layer_trace to true in console.h to record every console layer call and redraw into a
+  compact trace, logged as "CONSOLE_TRACE" hex lines when it fills up or when console_trace_dump() is called.
+  Capture them with "pebble logs > session.log", then replay them on your computer:
+
+    cc -O2 -I tools/replay -I src tools/replay/replay.c tools/replay/pebble.c src/console.c -o replay
+    ./replay session.log
+
+  The replay reports the time taken per kind of call, the peak heap and how much text each redraw drew.
+
+
+
+
+9) Optional: Keep a log without a layer
+  A console layer's text lives in a console log.  You can create a log by itself (e.g. in init(), before
+  any window exists) and write to it whenever you like.  Nothing is drawn until a layer shows it:
+
+    ConsoleLog *my_log = console_log_create(1000);
+    console_log_write_text(my_log, "Program Started");
+    my_console_layer = console_layer_create_with_log(window_frame, my_log);  // Later, in a window's load handler
+
+  The log keeps its text when the layer is destroyed, and more than one layer can show it (each with its own style).
+  console_layer_set_log() switches which log a layer shows.  Writing to a layer writes to the log it shows.
+  Destroy it with console_log_destroy(my_log).  Any layers still showing it are left blank.
+
+
+
+10) Optional: Keep errors longer than chatter
+  Normally the oldest text is pushed out first, so a burst of debug lines can push out the one error you
+  needed to see.  Reserve part of the log's buffer for high priority text and it's only pushed out by
+  newer high priority text:
+
+    console_layer_reserve_priority(my_console_layer, 100);  // The last 100 bytes of the buffer.  Clears the text.
+    console_layer_write_text_priority(my_console_layer, "ERROR!", ConsolePriorityHigh, GColorRed, GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit);
+
+  Both kinds of text are still shown together in the order they were written.  High priority text uses 4
+  more bytes each.  Reserve 0 bytes to give the whole buffer back to normal text.
+
+
+
+11) Optional: Fit more lines in a small buffer
+  A packed log stores the most common characters in 4 or 8 bits instead of 8, so the same buffer holds
+  about 1.35 to 1.4 times as many short worded lines (1.1 to 1.2 times for lines that are mostly numbers):
+
+    console_layer_set_packed(my_console_layer, true);  // Clears the text
+
+  Other characters take 12 bits, but no text takes more than 1 byte over its plain size.  Text is only
+  unpacked as it's drawn, so packing takes no more heap.
+
+
+
+12) Optional: Send a log to the phone
+  Set console_layer_phone_export to true in console.h, open AppMessage, then export whenever you like:
+
+    app_message_open(64, APP_MESSAGE_OUTBOX_SIZE_MINIMUM);  // In init()
+    console_layer_export(my_console_layer);                  // Returns false if an export is already running
+
+  The text is sent oldest first, in batches as big as the outbox, each once the phone has acknowledged the
+  last (and sent again if it fails).  Text written over before it's sent shows up as "[N lines skipped]".
+  src/js/console_export.js puts it back together on the phone, and src/js/app.js logs it.
+  While exporting, it takes over AppMessage's outbox sent and failed handlers (passing on your own messages'
+  results), and one batch is kept on the heap.
+
+
+
+13) Optional: Pin a status line
+  For status that changes often, pin a line above or below the scrolling text instead of writing new lines:
+
+    Layer *status_line = console_layer_add_pinned(my_console_layer, ConsolePinBottom, 32);  // Up to 31 bytes
+    console_layer_update_pinned(status_line, "BT: connected");
+
+  It has a one line slot of its own and updating it takes no room in the buffer.  It still costs a full
+  console redraw (Pebble redraws the whole window), but only if the text changed.  It uses the layer's text color, alignment and font (as it was when
+  pinned).  console_layer_destroy removes it, or remove it sooner with console_layer_remove_pinned().
+
+
+
+14) Optional: Draw small text quicker
+  Set console_layer_glyphs to true in console.h and use GFontConsoleGlyphs as a font:
+
+    console_layer_set_font(my_console_layer, GFontConsoleGlyphs);
+
+  Its text is drawn straight into the frame buffer from a built-in 5x7 pixel font (about GOTHIC_09's
+  size), skipping the system's text engine.  Only printable ASCII has glyphs (the rest are boxes), and
+  the text is clipped to the console layer but not to the layers it's inside.
+
+
+
+15) Optional: Skip the walk after text is written over
+  When new text writes over the oldest, the log walks its whole buffer to find where the text that's still
+  whole ends, the first time it's drawn after that (a cost that grows with the buffer size).  Set
+  console_layer_chunk_lengths to true in console.h to end each line with a length byte instead: the log then
+  knows at once, for a byte more per line.
+
+
+
+
 ----------------------------------------------------------------------------------------------------
  Console Layer Plus
 --------------------------------------------------
@@ -222,11 +353,21 @@ most standard Pebble layer functions with your console layer including (but not
 */
 
 static Window *main_window;
-static Layer *console_layer, *mini_console_layer;
+static Layer *console_layer, *mini_console_layer, *presses_line;
+static int presses;
+static ConsoleLog *mini_console_log;
 
 // ---------------------------------------------------------------------------------------------- //
 //  Button Functions
 // ---------------------------------------------------------------------------------------------- //
+static void count_press(void) {
+  // Update the line pinned below the main console's text (no new line is written)
+  char text[16];  // Copied into the pinned line, so it can be temporary
+  snprintf(text, sizeof(text), "Presses: %d", ++presses);
+  console_layer_update_pinned(presses_line, text);
+}
+
+
 static void up_hold_click_handler(ClickRecognizerRef recognizer, void *context) { //  UP  button held
   // Write some text but color it blue (use layer's settings for all other properties)
   // Notice the blue stays blue despite pressing down and changing the layer's style.  All Inherited properties change, though.
@@ -238,7 +379,8 @@ static void up_hold_click_handler(ClickRecognizerRef recognizer, void *context)
 static void up_click_handler(ClickRecognizerRef recognizer, void *context) {      //   UP   button
   // Write some text using the layer's settings
   console_layer_write_text(console_layer, "Hello World!");
-  console_layer_write_text(mini_console_layer, "Up Pressed");
+  console_layer_write_text(mini_console_layer, "Up " CONSOLE_GREEN "Pressed");
+  count_press();
 }
 
 
@@ -251,7 +393,8 @@ static void sl_hold_click_handler(ClickRecognizerRef recognizer, void *context)
 static void sl_click_handler(ClickRecognizerRef recognizer, void *context) {      // SELECT button pressed briefly
   // Emoji and color test. Notice the this text doesn't change when pressing down as no properties are set to Inherit from the layer
   console_layer_write_text_styled(console_layer, "ERROR: \U0001F4A9 Detected", PBL_IF_COLOR_ELSE(GColorRed, GColorWhite), GColorBlack, fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD), GTextAlignmentCenter, true);
-  console_layer_write_text_styled(mini_console_layer, "ERROR!", PBL_IF_COLOR_ELSE(GColorRed, GColorWhite), GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit);
+  console_layer_write_text_priority(mini_console_layer, "ERROR!", ConsolePriorityHigh, PBL_IF_COLOR_ELSE(GColorRed, GColorWhite), GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit);  // Outlasts "Up Held" etc.
+  count_press();
 }
 
 
@@ -279,6 +422,7 @@ static void dn_click_handler(ClickRecognizerRef recognizer, void *context) {
     case 3: console_layer_set_text_color(console_layer, GColorPurple);  break;
   }
   console_layer_write_text(mini_console_layer, "Changed Style");
+  count_press();
 }
 
 
@@ -288,6 +432,14 @@ static void dn_hold_click_handler(ClickRecognizerRef recognizer, void *context)
 }
 
 
+#if (console_layer_phone_export)
+static void up_double_click_handler(ClickRecognizerRef recognizer, void *context) { //  UP  button double clicked
+  // Send the mini console's text to the phone (see it with "pebble logs")
+  console_log_write_text(mini_console_log, console_log_export(mini_console_log) ? "Exporting" : "Busy");
+}
+#endif
+
+
 static void click_config_provider(void *context) {
   window_single_click_subscribe(BUTTON_ID_UP,     up_click_handler);
   window_single_click_subscribe(BUTTON_ID_SELECT, sl_click_handler);
@@ -295,6 +447,9 @@ static void click_config_provider(void *context) {
   window_long_click_subscribe  (BUTTON_ID_UP,     0, up_hold_click_handler, NULL);
   window_long_click_subscribe  (BUTTON_ID_SELECT, 0, sl_hold_click_handler, NULL);
   window_long_click_subscribe  (BUTTON_ID_DOWN,   0, dn_hold_click_handler, NULL);
+  #if (console_layer_phone_export)
+  window_multi_click_subscribe (BUTTON_ID_UP,     2, 2, 0, true, up_double_click_handler);
+  #endif
 }
 
 
@@ -317,34 +472,52 @@ static void main_window_load(Window *window) {
   // Enable word wrap (default has word wrap off)
   console_layer_set_word_wrap(console_layer, true);
   
+  // Pin a line below the text to count button presses (sized for the layer's font, GOTHIC_14 by default)
+  presses_line = console_layer_add_pinned(console_layer, ConsolePinBottom, 16);
+  console_layer_update_pinned(presses_line, "Presses: 0");
+  presses = 0;
+  
 
   // Create a second mini console layer
   int16_t width = 80, height = 50;
   rect = GRect((layer_get_frame(root_layer).size.w - width) / 2, 10, width, height);
-  mini_console_layer = console_layer_create_with_buffer_size(rect, 100);  // Create layer with 100 byte buffer (it's a tiny layer)
+  mini_console_layer = console_layer_create_with_log(rect, mini_console_log);  // Show the log created in init()
   layer_add_child(root_layer, mini_console_layer);
   
   // Configure mini console layer with white on black word-wrapped text using a tiny centered font
-  console_layer_set_style(mini_console_layer, GColorWhite, GColorBlack, fonts_get_system_font(FONT_KEY_GOTHIC_09), GTextAlignmentCenter, true);
+  #if (console_layer_glyphs)
+  GFont mini_font = GFontConsoleGlyphs;  // Drawn straight into the frame buffer
+  #else
+  GFont mini_font = fonts_get_system_font(FONT_KEY_GOTHIC_09);
+  #endif
+  console_layer_set_style(mini_console_layer, GColorWhite, GColorBlack, mini_font, GTextAlignmentCenter, true);
   
   // Hiding the mini console layer
   // Note: uses the standard Pebble set hidden function -- most standard Layer functions will work on Console Layers
   layer_set_hidden(mini_console_layer, true);
   
   // Write some text
-  console_layer_write_text(mini_console_layer, "Program Started");
   console_layer_write_text(console_layer, "Welcome!\nTry pressing and holding some buttons!");
 }
 
 
 static void main_window_unload(Window *window) {
-  // Destroy the layers with the standard Pebble layer destroy function
-  layer_destroy(mini_console_layer);
-  layer_destroy(console_layer);
+  // Destroy the layers (the mini console's log keeps its text, and the main console's pinned line goes with it)
+  console_layer_destroy(mini_console_layer);
+  console_layer_destroy(console_layer);
 }
 
 
 static void init() {
+  // Create a log for the mini console layer before there's any window to show it on
+  mini_console_log = console_log_create(100);  // 100 byte buffer (it's a tiny layer)
+  console_log_set_packed(mini_console_log, true);  // Fits about 1.4 times as many lines in it
+  console_log_reserve_priority(mini_console_log, 30);  // Keep the last 30 bytes for errors
+  console_log_write_text(mini_console_log, "Program Started");
+  #if (console_layer_phone_export)
+  app_message_open(APP_MESSAGE_INBOX_SIZE_MINIMUM, APP_MESSAGE_OUTBOX_SIZE_MINIMUM);  // For exporting to the phone
+  #endif
+
   // Create main Window
   main_window = window_create();
   window_set_window_handlers(main_window, (WindowHandlers) {
@@ -358,6 +531,7 @@ static void init() {
 
 static void deinit() {
   window_destroy(main_window);  // Destroy main Window
+  console_log_destroy(mini_console_log);
 }
 
 
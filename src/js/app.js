@@ -0,0 +1,10 @@
+// Phone side of the example app: Logs each console export the watch sends (see console_export.js)
+var ConsoleExport = require('./console_export');
+
+var consoleExport = new ConsoleExport(function(lines) {
+  console.log('Console export: ' + lines.length + ' lines\n' + lines.join('\n'));
+});
+
+Pebble.addEventListener('appmessage', function(e) {
+  consoleExport.receive(e.payload);
+});
@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------------------------//
+// Console Export: Puts a console log sent from the watch back together (see Export in console.h)
+//   var ConsoleExport = require('./console_export');
+//   var consoleExport = new ConsoleExport(function(lines) { ... });
+//   Pebble.addEventListener('appmessage', function(e) { consoleExport.receive(e.payload); });
+// Each text written to the log is one line (a text with \n in it stays one line).  Texts written
+//   over before they could be sent show up as one "[N lines skipped]" line where they were.
+//------------------------------------------------------------------------------------------------//
+var CONSOLE_EXPORT_KEY = 0x434F4E00;  // Same as in console.h
+var KEY_EXPORT  = CONSOLE_EXPORT_KEY + 0;
+var KEY_BATCH   = CONSOLE_EXPORT_KEY + 1;
+var KEY_TEXT    = CONSOLE_EXPORT_KEY + 2;
+var KEY_SKIPPED = CONSOLE_EXPORT_KEY + 3;
+var KEY_DONE    = CONSOLE_EXPORT_KEY + 4;
+
+// onDone(lines) is called with every line of an export once its last batch arrives
+function ConsoleExport(onDone) {
+  this.onDone = onDone;
+  this.exportNumber = null;  // Export being put together
+  this.batch = 0;            // Last batch added
+  this.lines = [];
+  this.partial = [];         // Bytes of a text that carries on in the next batch
+}
+
+// Decodes UTF-8 bytes, with U+FFFD for each broken character
+function decodeUtf8(bytes) {
+  var text = '';
+  for (var i = 0; i < bytes.length; ) {
+    var b = bytes[i++];
+    var extra = b < 0x80 ? 0 : b >= 0xC2 && b < 0xE0 ? 1 : b >= 0xE0 && b < 0xF0 ? 2 : b >= 0xF0 && b < 0xF5 ? 3 : -1;
+    var code = extra > 0 ? b & (0x3F >> extra) : b;
+    var j = 0;
+    for (; j < extra && i < bytes.length && (bytes[i] & 0xC0) === 0x80; j++)
+      code = code << 6 | (bytes[i++] & 0x3F);
+    if (extra < 0 || j < extra)
+      text += '\uFFFD';
+    else if (code > 0xFFFF)
+      text += String.fromCharCode(0xD800 + ((code - 0x10000) >> 10), 0xDC00 + ((code - 0x10000) & 0x3FF));
+    else
+      text += String.fromCharCode(code);
+  }
+  return text;
+}
+
+ConsoleExport.prototype.endPartial = function() {
+  if (this.partial.length) this.lines.push(decodeUtf8(this.partial));
+  this.partial = [];
+};
+
+// Adds an AppMessage payload to the export.  Returns false if it isn't part of one.
+ConsoleExport.prototype.receive = function(payload) {
+  var batch = payload[KEY_BATCH];
+  if (batch === undefined) return false;
+
+  if (payload[KEY_EXPORT] !== this.exportNumber) {
+    // A new export (anything left of an unfinished one is dropped)
+    this.exportNumber = payload[KEY_EXPORT];
+    this.batch = 0;
+    this.lines = [];
+    this.partial = [];
+  }
+  if (batch !== this.batch + 1) return true;  // Sent again after its acknowledgement got lost
+  this.batch = batch;
+
+  if (payload[KEY_SKIPPED]) {
+    this.endPartial();  // The rest of it was written over
+    this.lines.push('[' + payload[KEY_SKIPPED] + ' lines skipped]');
+  }
+  var text = payload[KEY_TEXT] || [];
+  for (var i = 0; i < text.length; i++) {
+    if (text[i] === 0) {
+      this.lines.push(decodeUtf8(this.partial));
+      this.partial = [];
+    } else {
+      this.partial.push(text[i]);
+    }
+  }
+  if (payload[KEY_DONE]) {
+    this.endPartial();
+    var lines = this.lines;
+    this.lines = [];
+    if (this.onDone) this.onDone(lines);
+  }
+  return true;
+};
+
+module.exports = ConsoleExport;
@@ -0,0 +1,403 @@
+/*
+----------------------------------------------------------------------------------------------------
+  Console Layer Checks
+----------------------------------------------------------------------------------------------------
+  Checks console.c on a computer against the stub in pebble.c: what gets drawn, and in what order.
+  console.c is built in (not linked) so its buffers can be looked at directly.
+
+  Build:   cc -O2 -I tools/replay -I src tools/replay/console_test.c tools/replay/pebble.c -o console_test
+  Run:     ./console_test                 (prints each failed check, and exits 1 if there were any)
+
+  Build it with console_layer_trace set to false, like replay.  Checks of features that are turned off
+  in console.h are left out.
+----------------------------------------------------------------------------------------------------
+*/
+#include "console.c"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#undef malloc
+#undef free
+
+static int checks, failures;
+
+#define CHECK(test, ...) do {                       \
+  checks++;                                         \
+  if (!(test)) {                                    \
+    failures++;                                     \
+    printf("%s:%d: ", __func__, __LINE__);          \
+    printf(__VA_ARGS__);                            \
+    printf("\n");                                   \
+  }                                                 \
+} while (0)
+
+//------------------------------------------------------------------------------------------------//
+// Drawing
+//------------------------------------------------------------------------------------------------//
+#define MAX_DRAWN 512
+static char drawn[MAX_DRAWN][320];       // Text drawn by the last draw_layer, newest (bottom) first
+static int  drawn_count;
+
+static void record_draw(const char *text) {
+  if (drawn_count < MAX_DRAWN) snprintf(drawn[drawn_count], sizeof(drawn[0]), "%s", text);
+  drawn_count++;
+}
+
+static void draw_layer(Layer *layer) {
+  drawn_count = 0;
+  replay_draw_text_hook = record_draw;
+  replay_layer_draw(layer);
+  replay_draw_text_hook = NULL;
+}
+
+//------------------------------------------------------------------------------------------------//
+// Valid Chunks
+//------------------------------------------------------------------------------------------------//
+// What the ring keeps of its oldest whole chunk matches walking it from the newest (unless it's stale)
+static void check_ring(console_ring *ring, bool stamped, const char *after) {
+  if (!ring->buffer_size || ring->stale) return;
+  uintptr_t oldest = ring->oldest;
+  size_t    used   = ring->used;
+  console_ring_find_oldest(ring, stamped);
+  CHECK(oldest == ring->oldest && (!oldest || used == ring->used), "after %s: oldest %u used %u, walking finds oldest %u used %u",
+        after, (unsigned)oldest, (unsigned)used, (unsigned)ring->oldest, (unsigned)ring->used);
+  ring->oldest = oldest;  // Leave it as it was, so the next write carries on from what the ring kept
+  ring->used   = used;
+}
+
+static void check_rings(ConsoleLog *log, const char *after) {
+  check_ring(&log->ring, false, after);
+  check_ring(&log->priority, true, after);
+}
+
+// Newest lines written by write_lines, newest first
+#define MAX_WRITTEN 64
+static char written[MAX_WRITTEN][320];
+static int  written_count;
+
+// Writes count plain lines of length characters each (then checks the rings), numbering them on from written_count
+static void write_lines(ConsoleLog *log, int count, int length) {
+  for (int i = 0; i < count; i++) {
+    memmove(written[1], written[0], sizeof(written) - sizeof(written[0]));
+    int n = snprintf(written[0], sizeof(written[0]), "%d:", written_count++);
+    for (; n < length; n++) written[0][n] = 'a' + n % 26;
+    written[0][length] = 0;
+    console_log_write_text(log, written[0]);
+    check_rings(log, written[0]);
+  }
+}
+
+// Draws the log, and checks it shows the newest lines written, as many as whole plain chunks fit (any if packed)
+static void check_drawn(Layer *layer, ConsoleLog *log, const char *after) {
+  draw_layer(layer);
+  int expected = 0;
+  size_t size = 0;
+  while (expected < written_count && expected < MAX_WRITTEN &&
+         (size += 1 + strlen(written[expected]) + 1 + CHUNK_LENGTH) <= log->ring.buffer_size - 1)
+    expected++;
+  if (!log->packed)
+    CHECK(drawn_count == expected, "after %s: %d lines drawn, not %d", after, drawn_count, expected);
+  for (int i = 0; i < drawn_count && i < MAX_WRITTEN; i++)
+    CHECK(!strcmp(drawn[i], written[i]), "after %s: row %d from the bottom is %s, not %s", after, i, drawn[i], written[i]);
+  check_rings(log, after);
+}
+
+static void check_valid_chunks(bool packed) {
+  ConsoleLog *log = console_log_create(100);
+  Layer *layer = console_layer_create_with_log(GRect(0, 0, 144, 2000), log);
+  console_log_set_packed(log, packed);
+  written_count = 0;
+
+  // Fill it, then wrap over the end of the buffer, cutting into the oldest line each time
+  write_lines(log, 6, 10);
+  check_drawn(layer, log, "filling it");
+  for (int i = 0; i < 20; i++) {
+    write_lines(log, 1, 5 + i % 13);
+    if (console_layer_chunk_lengths)
+      CHECK(!log->ring.stale, "wrapping: stale, though every line has a length byte");
+    check_drawn(layer, log, "wrapping");
+  }
+
+  // A line too long for the buffer is truncated, and pushes everything else out
+  char long_line[300];
+  memset(long_line, 'x', sizeof(long_line) - 1);
+  long_line[sizeof(long_line) - 1] = 0;
+  console_log_write_text(log, long_line);
+  check_rings(log, "a truncated line");
+  draw_layer(layer);
+  CHECK(drawn_count == 1, "a truncated line: %d lines drawn", drawn_count);
+  written_count = 0;
+  write_lines(log, 3, 20);
+  check_drawn(layer, log, "writing after a truncated line");
+
+  // Clearing leaves nothing to draw, and writing carries on from there
+  console_log_clear(log);
+  CHECK(!log->ring.oldest && !log->ring.stale, "clearing: oldest %u", (unsigned)log->ring.oldest);
+  draw_layer(layer);
+  CHECK(drawn_count == 0, "clearing: %d lines drawn", drawn_count);
+  written_count = 0;
+  write_lines(log, 12, 8);
+  check_drawn(layer, log, "writing after clearing");
+
+  console_layer_destroy(layer);
+  console_log_destroy(log);
+}
+
+// A line too long for its length byte leaves the ring to be walked again once the line before it is cut into
+static void check_long_chunks(void) {
+  ConsoleLog *log = console_log_create(700);
+  Layer *layer = console_layer_create_with_log(GRect(0, 0, 144, 2000), log);
+  written_count = 0;
+  write_lines(log, 1, 10);
+  write_lines(log, 1, 300);
+  CHECK(!log->ring.stale, "a long line: stale before anything's cut into");
+  write_lines(log, 10, 40);
+  CHECK(log->ring.stale, "a long line: not stale once the line before it is cut into");
+  check_drawn(layer, log, "a long line");
+  CHECK(!log->ring.stale, "a long line: still stale after drawing");
+  write_lines(log, 20, 40);
+  check_drawn(layer, log, "cutting into a long line");
+  console_layer_destroy(layer);
+  console_log_destroy(log);
+}
+
+// Random writes of every kind, to every kind of log, checking the rings after each one
+static uint32_t seed = 7;
+static uint32_t random_number(uint32_t below) {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % below;
+}
+
+static void check_random_writes(void) {
+  static const char *pieces[] = {"e", "t", " ", "a", "Up Held", "ERROR", "\xc3\xa9", "\t", "\x01", "\n", "42", "\x1b[31m", "\x1b[0m", "\x7f", "\xff",
+                                 "a much longer piece of text that goes on and on and on and on and on"};
+  for (int trial = 0; trial < 2000; trial++) {
+    int size = 8 + random_number(random_number(4) ? 300 : 2000);
+    ConsoleLog *log = console_log_create(size);
+    Layer *layer = console_layer_create_with_log(GRect(0, 0, 144, 300), log);
+    if (random_number(2)) console_log_set_packed(log, true);
+    if (!random_number(3)) console_log_reserve_priority(log, random_number(size));
+    int lines = random_number(200);
+    for (int i = 0; i < lines; i++) {
+      char line[4000];
+      int length = snprintf(line, sizeof(line), "%d", i);
+      int pieces_count = random_number(random_number(5) ? 8 : 60);
+      for (int j = 0; j < pieces_count; j++)
+        length += snprintf(line + length, sizeof(line) - length, "%s", pieces[random_number(16)]);
+      switch (random_number(4)) {
+        case 0:  console_log_write_text(log, line); break;
+        case 1:  console_log_write_split(log, line, GColorInherit, GColorBlue, GFontInherit, GTextAlignmentInherit, WordWrapInherit); break;
+        case 2:  console_log_write_text_styled(log, line, GColorRed, GColorBlue, fonts_get_system_font(FONT_KEY_GOTHIC_14), GTextAlignmentRight, WordWrapTrue); break;
+        default: console_log_write_text_priority(log, line, random_number(2), GColorRed, GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit); break;
+      }
+      check_rings(log, "a random write");
+      if (!random_number(6))  replay_layer_draw(layer);
+      if (!random_number(50)) console_log_clear(log);
+    }
+    replay_layer_draw(layer);
+    console_layer_destroy(layer);
+    console_log_destroy(log);
+  }
+}
+
+static void check_rings_all(void) {
+  check_valid_chunks(false);
+  check_valid_chunks(true);
+  check_long_chunks();
+  check_random_writes();
+}
+
+//------------------------------------------------------------------------------------------------//
+// Logs
+//------------------------------------------------------------------------------------------------//
+// A layer's own log isn't freed by console_log_destroy (it's inside the layer's data), and the layer keeps it
+static void check_own_log_destroy(void) {
+  size_t heap_used = replay_stats.heap_used;
+  Layer *layer = console_layer_create_with_buffer_size(GRect(0, 0, 144, 168), 200);
+  size_t layer_heap = replay_stats.heap_used;
+  console_layer_write_text(layer, "kept");
+  console_log_destroy(console_layer_get_log(layer));
+  CHECK(replay_stats.heap_used == layer_heap, "destroying a layer's own log changed the heap by %d bytes", (int)(replay_stats.heap_used - layer_heap));
+  draw_layer(layer);
+  CHECK(drawn_count == 1 && !strcmp(drawn[0], "kept"), "layer lost its text (%d lines drawn)", drawn_count);
+  console_layer_destroy(layer);
+  CHECK(replay_stats.heap_used == heap_used, "destroying the layer left %d bytes", (int)(replay_stats.heap_used - heap_used));
+
+  // A log of its own is destroyed, and a layer showing it is left blank
+  ConsoleLog *log = console_log_create(200);
+  layer = console_layer_create_with_log(GRect(0, 0, 144, 168), log);
+  console_log_write_text(log, "gone");
+  console_log_destroy(log);
+  draw_layer(layer);
+  CHECK(drawn_count == 0, "%d lines drawn from a destroyed log", drawn_count);
+  console_layer_destroy(layer);
+  CHECK(replay_stats.heap_used == heap_used, "destroying a log and its layer left %d bytes", (int)(replay_stats.heap_used - heap_used));
+}
+
+//------------------------------------------------------------------------------------------------//
+// High Priority Text
+//------------------------------------------------------------------------------------------------//
+// A priority line stays above every normal line written after it, however many that is
+static void check_priority_order(uint32_t normal_lines) {
+  ConsoleLog *log = console_log_create(200);
+  console_log_reserve_priority(log, 40);
+  console_log_write_text_priority(log, "ERROR", ConsolePriorityHigh, GColorRed, GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit);
+  char line[16];
+  for (uint32_t i = 0; i < normal_lines; i++) {
+    snprintf(line, sizeof(line), "d%u", (unsigned)i);
+    console_log_write_text(log, line);
+  }
+  Layer *layer = console_layer_create_with_log(GRect(0, 0, 144, 2000), log);
+  draw_layer(layer);
+  CHECK(drawn_count > 1 && !strcmp(drawn[drawn_count - 1], "ERROR"), "%u lines: ERROR isn't the oldest line drawn", (unsigned)normal_lines);
+  for (int i = 0; i < drawn_count - 1 && i < MAX_DRAWN; i++) {
+    snprintf(line, sizeof(line), "d%u", (unsigned)(normal_lines - 1 - i));
+    CHECK(!strcmp(drawn[i], line), "%u lines: row %d from the bottom is %s, not %s", (unsigned)normal_lines, i, drawn[i], line);
+  }
+  console_layer_destroy(layer);
+  console_log_destroy(log);
+}
+
+static void check_priority(void) {
+  check_priority_order(10);
+  check_priority_order(32769);  // Past where a 16 bit difference turns negative
+  check_priority_order(65539);  // Past where a 16 bit stamp comes back round to just before the line
+}
+
+//------------------------------------------------------------------------------------------------//
+// Export
+//------------------------------------------------------------------------------------------------//
+#if (console_layer_phone_export)
+// The text of the batch waiting in the outbox, with its lines' 0s made '|' (NULL = no text)
+static const char* outbox_text(void) {
+  static char text[1024];
+  Tuple *tuple = replay_outbox() ? dict_find(replay_outbox(), CONSOLE_EXPORT_KEY + 2) : NULL;
+  if (!tuple) return NULL;
+  const uint8_t *data = (const uint8_t*)tuple->value;
+  int length = tuple->length < (int)sizeof(text) - 1 ? tuple->length : (int)sizeof(text) - 1;
+  for (int i = 0; i < length; i++) text[i] = data[i] ? data[i] : '|';
+  text[length] = 0;
+  return text;
+}
+
+// A priority line is exported before every normal line written after it, however many that is
+static void check_export_priority_order(void) {
+  ConsoleLog *log = console_log_create(200);
+  console_log_reserve_priority(log, 40);
+  console_log_write_text_priority(log, "ERROR", ConsolePriorityHigh, GColorRed, GColorInherit, GFontInherit, GTextAlignmentInherit, WordWrapInherit);
+  char line[16];
+  for (uint32_t i = 0; i < 40000; i++) {
+    snprintf(line, sizeof(line), "d%u", (unsigned)i);
+    console_log_write_text(log, line);
+  }
+  console_log_export(log);
+  const char *text = outbox_text();
+  CHECK(text && !strncmp(text, "ERROR|", 6), "batch starts with %s", text ? text : "nothing");
+  CHECK(text && strstr(text, "|d39999|"), "batch is missing the newest line: %s", text ? text : "nothing");
+  while (replay_outbox()) replay_outbox_finish(APP_MSG_OK);
+  CHECK(!console_export_running(), "export still running");
+  console_log_destroy(log);
+}
+
+// Every batch but the last is filled, and together they have every whole line, in order
+static void check_export_full_batches(void) {
+  ConsoleLog *log = console_log_create(3000);
+  Layer *layer = console_layer_create_with_log(GRect(0, 0, 144, 30000), log);
+  char line[16];
+  for (int i = 0; i < 500; i++) {
+    snprintf(line, sizeof(line), "line %d", i);
+    console_log_write_text(log, line);
+  }
+  draw_layer(layer);
+  int first = drawn_count ? atoi(drawn[drawn_count - 1] + 5) : 0;
+
+  console_log_export(log);
+  static char text[4096];
+  size_t length = 0;
+  int batches = 0;
+  for (DictionaryIterator *outbox; (outbox = replay_outbox()); replay_outbox_finish(APP_MSG_OK), batches++) {
+    Tuple *tuple = dict_find(outbox, CONSOLE_EXPORT_KEY + 2);
+    size_t batch_length = tuple ? tuple->length : 0;
+    if (!dict_find(outbox, CONSOLE_EXPORT_KEY + 4))
+      CHECK(batch_length == export_state.capacity, "batch %d has %u of %u bytes", batches + 1, (unsigned)batch_length, (unsigned)export_state.capacity);
+    if (tuple && length + batch_length < sizeof(text)) memcpy(text + length, tuple->value, batch_length);
+    length += batch_length;
+  }
+  CHECK(batches > 2, "only %d batches", batches);
+  CHECK(!console_export_running(), "export still running");
+
+  int lines = 0;
+  for (size_t at = 0; at < length && at < sizeof(text); at += strlen(text + at) + 1, lines++) {
+    snprintf(line, sizeof(line), "line %d", first + lines);
+    CHECK(!strcmp(text + at, line), "line %d exported is %s, not %s", lines, text + at, line);
+  }
+  CHECK(lines == drawn_count, "%d lines exported, %d drawn", lines, drawn_count);
+  console_layer_destroy(layer);
+  console_log_destroy(log);
+}
+
+// A batch that fails is sent again as it was, waiting twice as long each time, until the export gives up
+static void check_export_retries(void) {
+  ConsoleLog *log = console_log_create(500);
+  char line[16];
+  for (int i = 0; i < 40; i++) {
+    snprintf(line, sizeof(line), "line %d", i);
+    console_log_write_text(log, line);
+  }
+  console_log_export(log);
+  uint8_t number = dict_find(replay_outbox(), CONSOLE_EXPORT_KEY)->value->uint8;
+  static char first_text[1024];
+  snprintf(first_text, sizeof(first_text), "%s", outbox_text());
+  for (int retry = 0; retry < EXPORT_RETRIES; retry++) {
+    replay_outbox_finish(APP_MSG_SEND_TIMEOUT);
+    CHECK(!replay_outbox(), "retry %d: sent again without waiting", retry);
+    uint32_t failed_ms = replay_timer_ms();
+    CHECK(replay_fire_timer(), "retry %d: nothing waiting to send it again", retry);
+    CHECK(replay_timer_ms() - failed_ms == (uint32_t)EXPORT_RETRY_MS << retry, "retry %d: waited %u ms", retry, (unsigned)(replay_timer_ms() - failed_ms));
+    CHECK(replay_outbox() && dict_find(replay_outbox(), CONSOLE_EXPORT_KEY + 1)->value->uint16 == 1, "retry %d: batch 1 not sent again", retry);
+    CHECK(replay_outbox() && !strcmp(outbox_text(), first_text), "retry %d: batch changed", retry);
+  }
+  replay_outbox_finish(APP_MSG_SEND_TIMEOUT);
+  CHECK(!console_export_running(), "export still running after %d retries", EXPORT_RETRIES);
+  CHECK(!replay_fire_timer(), "a timer still running after the export gave up");
+
+  // A new export starts over, and carries on after a retry once a batch gets through
+  CHECK(console_log_export(log), "new export refused");
+  CHECK(replay_outbox() && dict_find(replay_outbox(), CONSOLE_EXPORT_KEY)->value->uint8 != number, "new export has the old export's number");
+  replay_outbox_finish(APP_MSG_SEND_TIMEOUT);
+  replay_fire_timer();
+  CHECK(replay_outbox() && !strcmp(outbox_text(), first_text), "first batch changed");
+  int batches = 0;
+  while (replay_outbox() && batches++ < 100) {
+    replay_outbox_finish(APP_MSG_OK);
+    if (replay_outbox() && batches == 1) {
+      // Fail the second batch once too: it's sent again, and the first isn't
+      replay_outbox_finish(APP_MSG_BUSY);
+      replay_fire_timer();
+      CHECK(replay_outbox() && dict_find(replay_outbox(), CONSOLE_EXPORT_KEY + 1)->value->uint16 == 2, "batch 2 not sent again");
+    }
+  }
+  CHECK(!console_export_running(), "export not done after %d batches", batches);
+  console_log_destroy(log);
+}
+
+static void check_export(void) {
+  app_message_open(APP_MESSAGE_INBOX_SIZE_MINIMUM, 1000);
+  check_export_priority_order();
+  check_export_full_batches();
+  check_export_retries();
+}
+#endif
+
+//------------------------------------------------------------------------------------------------//
+int main(void) {
+  check_rings_all();
+  check_own_log_destroy();
+  check_priority();
+  #if (console_layer_phone_export)
+  check_export();
+  #endif
+  CHECK(replay_stats.heap_used == 0, "%zu heap bytes left allocated", replay_stats.heap_used);
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures != 0;
+}
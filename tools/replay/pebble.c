@@ -0,0 +1,362 @@
+//------------------------------------------------------------------------------------------------//
+// Stub Pebble SDK for building console.c on a computer (see replay.c)
+// Layers are real allocations, drawing is counted instead of drawn, and text is measured
+//   as if every font were fixed width.  The frame buffer is a real 8 bit one (like Basalt's).
+//------------------------------------------------------------------------------------------------//
+#include <pebble.h>
+#include <stdarg.h>
+#undef malloc
+#undef free
+
+#define STUB_HEAP_SIZE (24 * 1024)      // Same as Aplite, for heap_bytes_free()
+#define STUB_SCREEN_WIDTH  144
+#define STUB_SCREEN_HEIGHT 168
+
+ReplayStats replay_stats;
+void (*replay_draw_text_hook)(const char *text);
+
+struct Layer {
+  GRect           frame;
+  bool            hidden;
+  LayerUpdateProc update_proc;
+  uint8_t         data[];
+};
+
+struct GFontStub {
+  int16_t width;                        // Width of every character
+  int16_t height;                       // Height of a line
+};
+
+//------------------------------------------------------------------------------------------------//
+// Heap
+//----------------------------------------------//
+typedef union { size_t size; max_align_t align; } heap_header;
+
+void *replay_malloc(size_t size) {
+  heap_header *header = malloc(sizeof(heap_header) + size);
+  if (!header) return NULL;
+  header->size = size;
+  replay_stats.heap_used += size;
+  if (replay_stats.heap_used > replay_stats.heap_peak) replay_stats.heap_peak = replay_stats.heap_used;
+  return header + 1;
+}
+
+void replay_free(void *ptr) {
+  if (!ptr) return;
+  heap_header *header = (heap_header*)ptr - 1;
+  replay_stats.heap_used -= header->size;
+  free(header);
+}
+
+size_t heap_bytes_free(void) {
+  return replay_stats.heap_used < STUB_HEAP_SIZE ? STUB_HEAP_SIZE - replay_stats.heap_used : 0;
+}
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms) {
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  uint16_t ms = now.tv_nsec / 1000000;
+  if (tloc)   *tloc = now.tv_sec;
+  if (out_ms) *out_ms = ms;
+  return ms;
+}
+
+
+//------------------------------------------------------------------------------------------------//
+// Layers
+//----------------------------------------------//
+Layer* layer_create_with_data(GRect frame, size_t data_size) {
+  Layer *layer = replay_malloc(sizeof(Layer) + data_size);
+  if (layer) {
+    memset(layer, 0, sizeof(Layer) + data_size);
+    layer->frame = frame;
+  }
+  return layer;
+}
+
+void  layer_destroy        (Layer *layer)                              {replay_free(layer);}
+void* layer_get_data       (const Layer *layer)                        {return (void*)layer->data;}
+GRect layer_get_frame      (const Layer *layer)                        {return layer->frame;}
+void  layer_set_frame      (Layer *layer, GRect frame)                 {layer->frame = frame;}
+GRect layer_get_bounds     (const Layer *layer)                        {return GRect(0, 0, layer->frame.size.w, layer->frame.size.h);}
+void  layer_set_clips      (Layer *layer, bool clips)                  {(void)layer; (void)clips;}
+void  layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {layer->update_proc = update_proc;}
+void  layer_mark_dirty     (Layer *layer)                              {(void)layer; replay_stats.dirty_marks++;}
+void  layer_add_child      (Layer *parent, Layer *child)               {(void)parent; (void)child;}
+void  layer_remove_from_parent(Layer *child)                           {(void)child;}
+bool  layer_get_hidden     (const Layer *layer)                        {return layer->hidden;}
+void  layer_set_hidden     (Layer *layer, bool hidden)                 {layer->hidden = hidden;}
+
+// Layers aren't in a tree here, so each is taken to be right inside the window
+GPoint layer_convert_point_to_screen(const Layer *layer, GPoint point) {return GPoint(layer->frame.origin.x + point.x, layer->frame.origin.y + point.y);}
+GRect  layer_convert_rect_to_screen (const Layer *layer, GRect rect)   {return (GRect){.origin = layer_convert_point_to_screen(layer, rect.origin), .size = rect.size};}
+
+void replay_layer_draw(Layer *layer) {
+  if (layer->update_proc && !layer->hidden)
+    layer->update_proc(layer, NULL);
+}
+
+
+//------------------------------------------------------------------------------------------------//
+// Graphics
+//----------------------------------------------//
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {(void)ctx; (void)color;}
+void graphics_context_set_text_color(GContext *ctx, GColor color) {(void)ctx; (void)color;}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+  (void)ctx; (void)rect; (void)corner_radius; (void)corner_mask;
+  replay_stats.fills++;
+}
+
+// Wraps text at newlines and at the box's width (by character, not by word)
+static GSize stub_text_size(const char *text, GFont font, GRect box) {
+  int16_t columns = font->width > 0 && box.size.w >= font->width ? box.size.w / font->width : 1;
+  int16_t lines = 1, line_width = 0, widest = 0, trailing_spaces = 0;
+  for (; *text; text++) {
+    if ((*text & 0xC0) == 0x80) continue;  // UTF-8 continuation byte
+    if (*text == '\n' || line_width == columns) {
+      lines++;
+      line_width = trailing_spaces = 0;
+      if (*text == '\n') continue;
+    }
+    line_width++;
+    trailing_spaces = *text == ' ' ? trailing_spaces + 1 : 0;
+    if (line_width - trailing_spaces > widest) widest = line_width - trailing_spaces;  // Pebble doesn't count trailing spaces
+  }
+  return GSize(widest * font->width, lines * font->height);
+}
+
+void graphics_draw_text(GContext *ctx, const char *text, GFont font, GRect box, GTextOverflowMode overflow_mode, GTextAlignment alignment, GTextAttributes *text_attributes) {
+  (void)ctx; (void)overflow_mode; (void)alignment; (void)text_attributes;
+  stub_text_size(text, font, box);  // Same walk over the text as the system would do
+  replay_stats.text_draws++;
+  if (replay_draw_text_hook) replay_draw_text_hook(text);
+}
+
+GSize graphics_text_layout_get_content_size(const char *text, GFont font, GRect box, GTextOverflowMode overflow_mode, GTextAlignment alignment) {
+  (void)overflow_mode; (void)alignment;
+  replay_stats.text_measures++;
+  return stub_text_size(text, font, box);
+}
+
+struct GBitmap {
+  uint8_t data[STUB_SCREEN_HEIGHT][STUB_SCREEN_WIDTH];
+};
+static GBitmap stub_frame_buffer;
+
+GBitmap* graphics_capture_frame_buffer(GContext *ctx) {
+  (void)ctx;
+  replay_stats.frame_buffer_captures++;
+  return &stub_frame_buffer;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {(void)ctx; (void)buffer; return true;}
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap) {(void)bitmap; return GBitmapFormat8Bit;}
+GRect gbitmap_get_bounds(const GBitmap *bitmap) {(void)bitmap; return GRect(0, 0, STUB_SCREEN_WIDTH, STUB_SCREEN_HEIGHT);}
+
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y) {
+  return (GBitmapDataRowInfo){.data = (uint8_t*)bitmap->data[y < STUB_SCREEN_HEIGHT ? y : 0], .min_x = 0, .max_x = STUB_SCREEN_WIDTH - 1};
+}
+
+
+//------------------------------------------------------------------------------------------------//
+// Fonts
+//----------------------------------------------//
+static struct GFontStub stub_fonts[] = {
+  {4,  9},   // GOTHIC_09
+  {6, 14},   // GOTHIC_14
+  {7, 14},   // GOTHIC_14_BOLD
+  {11, 28},  // GOTHIC_28
+  {14, 30},  // BITHAM_30_BLACK
+};
+#define STUB_FONT_COUNT (sizeof(stub_fonts) / sizeof(stub_fonts[0]))
+
+GFont fonts_get_system_font(const char *font_key) {
+  static const char *keys[STUB_FONT_COUNT] = {FONT_KEY_GOTHIC_09, FONT_KEY_GOTHIC_14, FONT_KEY_GOTHIC_14_BOLD, FONT_KEY_GOTHIC_28, FONT_KEY_BITHAM_30_BLACK};
+  for (size_t i = 0; i < STUB_FONT_COUNT; i++)
+    if (strcmp(font_key, keys[i]) == 0) return &stub_fonts[i];
+  return &stub_fonts[1];
+}
+
+// Stand-in fonts sized from a trace's Font records (height 0 = not recorded: older traces get one of the stub fonts)
+static struct GFontStub replay_fonts[256];
+
+GFont replay_font(uint8_t font_id) {
+  if (!font_id) return NULL;
+  return replay_fonts[font_id].height ? &replay_fonts[font_id] : &stub_fonts[(font_id - 1) % STUB_FONT_COUNT];
+}
+
+void replay_set_font(uint8_t font_id, int16_t height, int16_t width) {
+  replay_fonts[font_id] = (struct GFontStub){.width = width, .height = height};
+}
+
+
+//------------------------------------------------------------------------------------------------//
+// Timers
+//----------------------------------------------//
+// Timers never fire on their own: replay_fire_timer() fires them
+#define STUB_MAX_TIMERS 8
+
+struct AppTimer {
+  uint32_t         due_ms;              // When it's due, counting from the first timer registered
+  AppTimerCallback callback;
+  void            *data;
+};
+
+static struct AppTimer stub_timers[STUB_MAX_TIMERS];
+static uint32_t stub_timer_ms;          // When the last timer fired
+
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+  for (size_t i = 0; i < STUB_MAX_TIMERS; i++)
+    if (!stub_timers[i].callback) {
+      stub_timers[i] = (struct AppTimer){stub_timer_ms + timeout_ms, callback, callback_data};
+      return &stub_timers[i];
+    }
+  return NULL;
+}
+
+void app_timer_cancel(AppTimer *timer) {
+  if (timer) timer->callback = NULL;
+}
+
+bool replay_fire_timer(void) {
+  AppTimer *soonest = NULL;
+  for (size_t i = 0; i < STUB_MAX_TIMERS; i++)
+    if (stub_timers[i].callback && (!soonest || stub_timers[i].due_ms < soonest->due_ms))
+      soonest = &stub_timers[i];
+  if (!soonest) return false;
+  AppTimerCallback callback = soonest->callback;
+  soonest->callback = NULL;
+  stub_timer_ms = soonest->due_ms;
+  callback(soonest->data);
+  return true;
+}
+
+uint32_t replay_timer_ms(void) {
+  return stub_timer_ms;
+}
+
+
+//------------------------------------------------------------------------------------------------//
+// Dictionaries
+//----------------------------------------------//
+// Laid out like the real thing: a count byte, then tuples (7 byte header and their data)
+struct Dictionary {
+  uint8_t count;
+  Tuple   head[];
+};
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...) {
+  uint32_t size = sizeof(Dictionary);
+  va_list sizes;
+  va_start(sizes, tuple_count);
+  for (uint8_t i = 0; i < tuple_count; i++)
+    size += sizeof(Tuple) + va_arg(sizes, unsigned int);
+  va_end(sizes);
+  return size;
+}
+
+static DictionaryResult stub_dict_write(DictionaryIterator *iter, uint32_t key, TupleType type, const void *data, uint16_t size) {
+  if ((uint8_t*)iter->cursor + sizeof(Tuple) + size > (uint8_t*)iter->end) return DICT_NOT_ENOUGH_STORAGE;
+  iter->cursor->key    = key;
+  iter->cursor->type   = type;
+  iter->cursor->length = size;
+  memcpy(iter->cursor->value->data, data, size);
+  iter->cursor = (Tuple*)((uint8_t*)iter->cursor + sizeof(Tuple) + size);
+  iter->dictionary->count++;
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_data  (DictionaryIterator *iter, const uint32_t key, const uint8_t *data, const uint16_t size) {return stub_dict_write(iter, key, TUPLE_BYTE_ARRAY, data, size);}
+DictionaryResult dict_write_uint8 (DictionaryIterator *iter, const uint32_t key, const uint8_t value)                     {return stub_dict_write(iter, key, TUPLE_UINT, &value, sizeof(value));}
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, const uint32_t key, const uint16_t value)                    {return stub_dict_write(iter, key, TUPLE_UINT, &value, sizeof(value));}
+
+Tuple* dict_read_first(DictionaryIterator *iter) {
+  iter->cursor = iter->dictionary->head;
+  return iter->dictionary->count ? iter->cursor : NULL;
+}
+
+Tuple* dict_read_next(DictionaryIterator *iter) {
+  Tuple *next = (Tuple*)((uint8_t*)iter->cursor + sizeof(Tuple) + iter->cursor->length);
+  if ((uint8_t*)next >= (uint8_t*)iter->end) return NULL;
+  iter->cursor = next;
+  return next;
+}
+
+Tuple* dict_find(const DictionaryIterator *iter, const uint32_t key) {
+  Tuple *tuple = iter->dictionary->head;
+  for (uint8_t i = 0; i < iter->dictionary->count; i++) {
+    if (tuple->key == key) return tuple;
+    tuple = (Tuple*)((uint8_t*)tuple + sizeof(Tuple) + tuple->length);
+  }
+  return NULL;
+}
+
+
+//------------------------------------------------------------------------------------------------//
+// AppMessage
+//----------------------------------------------//
+// One outbox: begun, written and sent, then busy until replay_outbox_finish() answers for the phone
+static struct {
+  uint8_t               *buffer;        // NULL until app_message_open()
+  uint32_t               size;
+  DictionaryIterator     iterator;
+  bool                   begun;
+  bool                   sent;          // Waiting for the phone
+  AppMessageOutboxSent   sent_callback;
+  AppMessageOutboxFailed failed_callback;
+} stub_outbox;
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+  (void)size_inbound;
+  if (stub_outbox.buffer) return APP_MSG_INVALID_STATE;
+  stub_outbox.buffer = malloc(size_outbound);  // Not counted: the system holds it, not the app's heap
+  stub_outbox.size   = size_outbound;
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+  if (!stub_outbox.buffer) return APP_MSG_INVALID_STATE;
+  if (stub_outbox.begun || stub_outbox.sent) return APP_MSG_BUSY;
+  stub_outbox.iterator = (DictionaryIterator){(Dictionary*)stub_outbox.buffer, stub_outbox.buffer + stub_outbox.size, ((Dictionary*)stub_outbox.buffer)->head};
+  stub_outbox.iterator.dictionary->count = 0;
+  stub_outbox.begun = true;
+  *iterator = &stub_outbox.iterator;
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  if (!stub_outbox.begun) return APP_MSG_INVALID_STATE;
+  stub_outbox.begun = false;
+  stub_outbox.sent  = true;
+  replay_stats.messages_sent++;
+  replay_stats.message_bytes += (uint8_t*)stub_outbox.iterator.cursor - stub_outbox.buffer;
+  stub_outbox.iterator.end = stub_outbox.iterator.cursor;  // Reading stops at the last tuple written
+  return APP_MSG_OK;
+}
+
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback) {
+  AppMessageOutboxSent previous = stub_outbox.sent_callback;
+  stub_outbox.sent_callback = sent_callback;
+  return previous;
+}
+
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback) {
+  AppMessageOutboxFailed previous = stub_outbox.failed_callback;
+  stub_outbox.failed_callback = failed_callback;
+  return previous;
+}
+
+DictionaryIterator* replay_outbox(void) {
+  return stub_outbox.sent ? &stub_outbox.iterator : NULL;
+}
+
+void replay_outbox_finish(AppMessageResult result) {
+  if (!stub_outbox.sent) return;
+  stub_outbox.sent = false;
+  if (result == APP_MSG_OK) {
+    if (stub_outbox.sent_callback) stub_outbox.sent_callback(&stub_outbox.iterator, NULL);
+  } else {
+    if (stub_outbox.failed_callback) stub_outbox.failed_callback(&stub_outbox.iterator, result, NULL);
+  }
+}
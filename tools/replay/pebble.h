@@ -0,0 +1,217 @@
+#pragma once
+//------------------------------------------------------------------------------------------------//
+// Stub pebble.h for building console.c on a computer (see replay.c)
+// Only has the parts of the Pebble SDK the console layer library uses.
+//------------------------------------------------------------------------------------------------//
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+// Heap allocations are counted so replay can report the peak heap used
+void *replay_malloc(size_t size);
+void  replay_free(void *ptr);
+#define malloc(size) replay_malloc(size)
+#define free(ptr)    replay_free(ptr)
+
+
+//------------------------------------------------------------------------------------------------//
+// Types
+//------------------------------------------------------------------------------------------------//
+typedef union GColor8 {
+  uint8_t argb;
+  struct { uint8_t b:2; uint8_t g:2; uint8_t r:2; uint8_t a:2; };
+} GColor8;
+typedef GColor8 GColor;
+
+typedef struct GPoint { int16_t x; int16_t y; } GPoint;
+typedef struct GSize  { int16_t w; int16_t h; } GSize;
+typedef struct GRect  { GPoint origin; GSize size; } GRect;
+#define GPoint(x, y)       ((GPoint){(x), (y)})
+#define GSize(w, h)        ((GSize){(w), (h)})
+#define GRect(x, y, w, h)  ((GRect){{(x), (y)}, {(w), (h)}})
+#define GPointZero         GPoint(0, 0)
+
+typedef struct Layer    Layer;
+typedef struct GContext GContext;
+typedef struct GFontStub *GFont;
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+
+typedef enum { GTextAlignmentLeft, GTextAlignmentCenter, GTextAlignmentRight } GTextAlignment;
+typedef enum { GTextOverflowModeWordWrap, GTextOverflowModeTrailingEllipsis, GTextOverflowModeFill } GTextOverflowMode;
+typedef enum { GCornerNone = 0 } GCornerMask;
+typedef void GTextAttributes;
+
+typedef struct GBitmap GBitmap;
+typedef enum {
+  GBitmapFormat1Bit = 0, GBitmapFormat8Bit, GBitmapFormat1BitPalette, GBitmapFormat2BitPalette, GBitmapFormat4BitPalette, GBitmapFormat8BitCircular
+} GBitmapFormat;
+typedef struct GBitmapDataRowInfo {
+  uint8_t *data;                        // Row's byte at x = 0
+  int16_t  min_x;
+  int16_t  max_x;
+} GBitmapDataRowInfo;
+
+
+//------------------------------------------------------------------------------------------------//
+// Colors
+//------------------------------------------------------------------------------------------------//
+#define GColorARGB8(a, r, g, b)  ((GColor8){.argb = (uint8_t)(((a) << 6) | ((r) << 4) | ((g) << 2) | (b))})
+#define GColorClear              GColorARGB8(0, 0, 0, 0)
+#define GColorBlack              GColorARGB8(3, 0, 0, 0)
+#define GColorWhite              GColorARGB8(3, 3, 3, 3)
+#define GColorDarkGray           GColorARGB8(3, 1, 1, 1)
+#define GColorLightGray          GColorARGB8(3, 2, 2, 2)
+#define GColorRed                GColorARGB8(3, 3, 0, 0)
+#define GColorGreen              GColorARGB8(3, 0, 3, 0)
+#define GColorBlue               GColorARGB8(3, 0, 0, 3)
+#define GColorYellow             GColorARGB8(3, 3, 3, 0)
+#define GColorMagenta            GColorARGB8(3, 3, 0, 3)
+#define GColorCyan               GColorARGB8(3, 0, 3, 3)
+#define GColorOrange             GColorARGB8(3, 3, 1, 0)
+#define GColorPurple             GColorARGB8(3, 2, 0, 2)
+#define GColorSunsetOrange       GColorARGB8(3, 3, 1, 1)
+#define GColorScreaminGreen      GColorARGB8(3, 1, 3, 1)
+#define GColorIcterine           GColorARGB8(3, 3, 3, 1)
+#define GColorVeryLightBlue      GColorARGB8(3, 1, 1, 3)
+#define GColorShockingPink       GColorARGB8(3, 3, 1, 3)
+#define GColorElectricBlue       GColorARGB8(3, 1, 3, 3)
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_true)
+
+
+//------------------------------------------------------------------------------------------------//
+// Layers, Graphics and Fonts
+//------------------------------------------------------------------------------------------------//
+Layer*  layer_create_with_data(GRect frame, size_t data_size);
+void    layer_destroy         (Layer *layer);
+void*   layer_get_data        (const Layer *layer);
+GRect   layer_get_frame       (const Layer *layer);
+void    layer_set_frame       (Layer *layer, GRect frame);
+GRect   layer_get_bounds      (const Layer *layer);
+void    layer_set_clips       (Layer *layer, bool clips);
+void    layer_set_update_proc (Layer *layer, LayerUpdateProc update_proc);
+void    layer_mark_dirty      (Layer *layer);
+void    layer_add_child       (Layer *parent, Layer *child);
+void    layer_remove_from_parent(Layer *child);
+bool    layer_get_hidden      (const Layer *layer);
+void    layer_set_hidden      (Layer *layer, bool hidden);
+GPoint  layer_convert_point_to_screen(const Layer *layer, GPoint point);
+GRect   layer_convert_rect_to_screen (const Layer *layer, GRect rect);
+
+void    graphics_context_set_fill_color(GContext *ctx, GColor color);
+void    graphics_context_set_text_color(GContext *ctx, GColor color);
+void    graphics_fill_rect             (GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void    graphics_draw_text             (GContext *ctx, const char *text, GFont font, GRect box, GTextOverflowMode overflow_mode, GTextAlignment alignment, GTextAttributes *text_attributes);
+GSize   graphics_text_layout_get_content_size(const char *text, GFont font, GRect box, GTextOverflowMode overflow_mode, GTextAlignment alignment);
+
+GBitmap*           graphics_capture_frame_buffer(GContext *ctx);
+bool               graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer);
+GBitmapFormat      gbitmap_get_format       (const GBitmap *bitmap);
+GRect              gbitmap_get_bounds       (const GBitmap *bitmap);
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y);
+
+#define FONT_KEY_GOTHIC_09          "GOTHIC_09"
+#define FONT_KEY_GOTHIC_14          "GOTHIC_14"
+#define FONT_KEY_GOTHIC_14_BOLD     "GOTHIC_14_BOLD"
+#define FONT_KEY_GOTHIC_28          "GOTHIC_28"
+#define FONT_KEY_BITHAM_30_BLACK    "BITHAM_30_BLACK"
+GFont   fonts_get_system_font(const char *font_key);
+
+
+//------------------------------------------------------------------------------------------------//
+// System
+//------------------------------------------------------------------------------------------------//
+size_t   heap_bytes_free(void);
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms);
+
+typedef enum { APP_LOG_LEVEL_ERROR = 1, APP_LOG_LEVEL_WARNING = 50, APP_LOG_LEVEL_INFO = 100, APP_LOG_LEVEL_DEBUG = 200 } AppLogLevel;
+#define APP_LOG(level, ...) (printf(__VA_ARGS__), printf("\n"))
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+void      app_timer_cancel  (AppTimer *timer);
+
+
+//------------------------------------------------------------------------------------------------//
+// Dictionaries and AppMessage
+//------------------------------------------------------------------------------------------------//
+typedef enum { TUPLE_BYTE_ARRAY = 0, TUPLE_CSTRING = 1, TUPLE_UINT = 2, TUPLE_INT = 3 } TupleType;
+
+typedef struct __attribute__((__packed__)) Tuple {
+  uint32_t key;
+  uint8_t  type;
+  uint16_t length;
+  union { uint8_t data[0]; char cstring[0]; uint8_t uint8; uint16_t uint16; uint32_t uint32; } value[];
+} Tuple;
+
+typedef struct Dictionary Dictionary;
+typedef struct DictionaryIterator {
+  Dictionary *dictionary;
+  const void *end;
+  Tuple      *cursor;
+} DictionaryIterator;
+
+typedef enum { DICT_OK = 0, DICT_NOT_ENOUGH_STORAGE = 1 << 1, DICT_INVALID_ARGS = 1 << 2 } DictionaryResult;
+
+uint32_t         dict_calc_buffer_size(const uint8_t tuple_count, ...);
+DictionaryResult dict_write_data  (DictionaryIterator *iter, const uint32_t key, const uint8_t *data, const uint16_t size);
+DictionaryResult dict_write_uint8 (DictionaryIterator *iter, const uint32_t key, const uint8_t value);
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, const uint32_t key, const uint16_t value);
+Tuple*           dict_read_first  (DictionaryIterator *iter);
+Tuple*           dict_read_next   (DictionaryIterator *iter);
+Tuple*           dict_find        (const DictionaryIterator *iter, const uint32_t key);
+
+typedef enum {
+  APP_MSG_OK            = 0,
+  APP_MSG_SEND_TIMEOUT  = 1 << 1,
+  APP_MSG_SEND_REJECTED = 1 << 2,
+  APP_MSG_NOT_CONNECTED = 1 << 3,
+  APP_MSG_BUSY          = 1 << 6,
+  APP_MSG_INVALID_STATE = 1 << 15,
+} AppMessageResult;
+
+#define APP_MESSAGE_INBOX_SIZE_MINIMUM  124
+#define APP_MESSAGE_OUTBOX_SIZE_MINIMUM 636
+
+typedef void (*AppMessageOutboxSent)  (DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+AppMessageResult       app_message_open                  (const uint32_t size_inbound, const uint32_t size_outbound);
+AppMessageResult       app_message_outbox_begin          (DictionaryIterator **iterator);
+AppMessageResult       app_message_outbox_send           (void);
+AppMessageOutboxSent   app_message_register_outbox_sent  (AppMessageOutboxSent sent_callback);
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback);
+
+
+//------------------------------------------------------------------------------------------------//
+// Replay
+//------------------------------------------------------------------------------------------------//
+// Not part of the Pebble SDK: lets replay.c draw layers and read what the stub has counted
+typedef struct ReplayStats {
+  size_t   heap_used;                   // Bytes currently allocated
+  size_t   heap_peak;                   // Most bytes ever allocated at once
+  uint32_t text_draws;                  // graphics_draw_text() calls
+  uint32_t text_measures;               // graphics_text_layout_get_content_size() calls
+  uint32_t fills;                       // graphics_fill_rect() calls
+  uint32_t dirty_marks;                 // layer_mark_dirty() calls
+  uint32_t frame_buffer_captures;       // graphics_capture_frame_buffer() calls (drawing built-in glyphs)
+  uint32_t messages_sent;               // app_message_outbox_send() calls
+  uint32_t message_bytes;               // Bytes of the dictionaries sent
+} ReplayStats;
+
+extern ReplayStats replay_stats;
+void  replay_layer_draw(Layer *layer);  // Calls the layer's update proc, like the system does on redraw
+GFont replay_font(uint8_t font_id);     // A stand-in font for a trace font id (each has its own size)
+void  replay_set_font(uint8_t font_id, int16_t height, int16_t width);  // Sizes the stand-in font for a trace font id
+extern void (*replay_draw_text_hook)(const char *text);  // Called with each text drawn (NULL = none), for checking what's drawn
+
+// The message sent and waiting for the phone's answer (NULL = none), and answering it: APP_MSG_OK calls the
+//   outbox sent handler, anything else the outbox failed handler.  The outbox is busy until it's answered.
+DictionaryIterator* replay_outbox(void);
+void  replay_outbox_finish(AppMessageResult result);
+bool  replay_fire_timer(void);          // Fires the timer due soonest (regardless of the time).  False if there are none.
+uint32_t replay_timer_ms(void);        // When the last timer fired was due, counting from the first timer registered
@@ -0,0 +1,335 @@
+/*
+----------------------------------------------------------------------------------------------------
+  Console Layer Trace Replay
+----------------------------------------------------------------------------------------------------
+  Replays a trace recorded on a watch (see console_layer_trace in console.h) through console.c on a
+  computer, and reports how long each kind of call took, the peak heap and how much drawing was done.
+
+  Record:  Set console_layer_trace to true, run the app and capture its logs:
+             pebble logs > session.log
+  Build:   cc -O2 -I tools/replay -I src tools/replay/replay.c tools/replay/pebble.c src/console.c -o replay
+  Replay:  ./replay session.log            (or pipe the log in: ./replay < session.log)
+
+  Only the trace lines ("CONSOLE_TRACE ...") are read, so the rest of the log can stay in.
+  Build replay with console_layer_trace set back to false.
+  Text isn't recorded, only its length, so every write is replayed as that many 'x' characters.
+  Lines written together are replayed as equally long lines making up the recorded total length.
+  Drawing goes to the stub in pebble.c, which counts calls and measures text as fixed width.
+  Text in GFontConsoleGlyphs is really drawn (into the stub's frame buffer), and isn't counted in the rows drawn.
+  Exports are sent to the stub's AppMessage outbox (as big as the minimum), which the phone answers at once.
+  Pinned line updates are replayed as x's too, so an update as long as the last is replayed as unchanged.
+  Each font is replayed as a fixed width stand-in with the line height and average character width the
+    watch measured for it (recorded the first time the font was used, including each layer's default font).
+----------------------------------------------------------------------------------------------------
+*/
+#include <pebble.h>
+#include "console.h"
+#undef malloc  // replay's own allocations aren't counted in the peak heap
+#undef free
+
+#define MAX_TRACE_SIZE (1024 * 1024)
+#define MAX_IDS 256
+
+static const char *type_names[] = {
+  [ConsoleTraceCreate]             = "create",
+  [ConsoleTraceClear]              = "clear",
+  [ConsoleTraceSetStyle]           = "set_style",
+  [ConsoleTraceSetBackgroundColor] = "set_background_color",
+  [ConsoleTraceSetTextColor]       = "set_text_color",
+  [ConsoleTraceSetAlignment]       = "set_alignment",
+  [ConsoleTraceSetWordWrap]        = "set_word_wrap",
+  [ConsoleTraceSetFont]            = "set_font",
+  [ConsoleTraceWrite]              = "write",
+  [ConsoleTraceRedraw]             = "redraw",
+  [ConsoleTraceCreateLog]          = "create_log",
+  [ConsoleTraceSetLog]             = "set_log",
+  [ConsoleTraceDestroy]            = "destroy",
+  [ConsoleTraceWriteLines]         = "write_lines",
+  [ConsoleTraceWritePriority]      = "write_priority",
+  [ConsoleTraceReservePriority]    = "reserve_priority",
+  [ConsoleTraceSetPacked]          = "set_packed",
+  [ConsoleTraceExport]             = "export",
+  [ConsoleTraceAddPinned]          = "add_pinned",
+  [ConsoleTraceUpdatePinned]       = "update_pinned",
+  [ConsoleTraceFont]               = "font",
+};
+#define TYPE_COUNT (sizeof(type_names) / sizeof(type_names[0]))
+
+typedef struct {
+  uint32_t count;
+  uint64_t total_ns;
+  uint64_t max_ns;
+} cost;
+
+
+//------------------------------------------------------------------------------------------------//
+// Reading the Trace
+//----------------------------------------------//
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Collects the bytes from every "CONSOLE_TRACE <hex>" line in the log
+static size_t read_trace(FILE *file, uint8_t *trace, size_t max_size) {
+  char line[1024];
+  size_t length = 0;
+  while (fgets(line, sizeof(line), file)) {
+    char *hex = strstr(line, "CONSOLE_TRACE ");
+    if (!hex) continue;
+    for (hex += strlen("CONSOLE_TRACE "); hex_value(hex[0]) >= 0 && hex_value(hex[1]) >= 0 && length < max_size; hex += 2)
+      trace[length++] = hex_value(hex[0]) << 4 | hex_value(hex[1]);
+  }
+  return length;
+}
+
+static uint16_t read_u16(const uint8_t *bytes) {
+  return bytes[0] | bytes[1] << 8;
+}
+
+static uint16_t arguments_size(uint8_t type) {
+  switch (type) {
+    case ConsoleTraceCreate:             return 11;
+    case ConsoleTraceCreateLog:          return 2;
+    case ConsoleTraceSetLog:             return 1;
+    case ConsoleTraceDestroy:            return 0;
+    case ConsoleTraceClear:              return 0;
+    case ConsoleTraceExport:             return 0;
+    case ConsoleTraceSetStyle:           return 5;
+    case ConsoleTraceSetBackgroundColor:
+    case ConsoleTraceSetTextColor:
+    case ConsoleTraceSetAlignment:
+    case ConsoleTraceSetWordWrap:
+    case ConsoleTraceSetFont:
+    case ConsoleTraceSetPacked:          return 1;
+    case ConsoleTraceWrite:
+    case ConsoleTraceWritePriority:      return 7;
+    case ConsoleTraceReservePriority:
+    case ConsoleTraceUpdatePinned:       return 2;
+    case ConsoleTraceAddPinned:          return 4;
+    case ConsoleTraceFont:               return 3;
+    case ConsoleTraceWriteLines:         return 9;
+    case ConsoleTraceRedraw:             return 3;
+    default:                             return UINT16_MAX;
+  }
+}
+
+// Font for a trace font id: the built-in glyphs, or a stand-in font
+static GFont trace_font(uint8_t font_id) {
+  #if (console_layer_glyphs)
+  if (font_id == 254) return GFontConsoleGlyphs;
+  #endif
+  return replay_font(font_id);
+}
+
+static uint64_t now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+
+//------------------------------------------------------------------------------------------------//
+// Replay
+//----------------------------------------------//
+int main(int argc, char *argv[]) {
+  FILE *file = argc > 1 ? fopen(argv[1], "r") : stdin;
+  if (!file) {
+    fprintf(stderr, "Unable to open %s\n", argv[1]);
+    return 1;
+  }
+  uint8_t *trace = calloc(1, MAX_TRACE_SIZE);
+  size_t length = read_trace(file, trace, MAX_TRACE_SIZE);
+  if (file != stdin) fclose(file);
+  if (length == 0) {
+    fprintf(stderr, "No CONSOLE_TRACE lines found\n");
+    return 1;
+  }
+
+  static Layer      *layers[MAX_IDS];  // Layers and logs share ids, so only one of these is set per id
+  static ConsoleLog *logs[MAX_IDS];
+  static bool        own_log[MAX_IDS];  // Log belongs to a layer, and is destroyed with it
+  static bool        pinned[MAX_IDS];   // Layer is a pinned line, removed with the layer it's pinned to
+  static cost costs[TYPE_COUNT];
+  char *text = calloc(1, UINT16_MAX + 1);
+  memset(text, 'x', UINT16_MAX);
+  char *lines = calloc(1, 2 * UINT16_MAX + 1);  // Up to UINT16_MAX characters and as many \n
+  uint64_t session_ms = 0, device_redraw_ms = 0, device_redraw_max_ms = 0;
+  uint32_t redraws = 0, device_rows = 0, replay_rows = 0, skipped = 0;
+  app_message_open(APP_MESSAGE_INBOX_SIZE_MINIMUM, APP_MESSAGE_OUTBOX_SIZE_MINIMUM);  // For exports
+
+  size_t i = 0;
+  while (i + 4 <= length) {
+    uint8_t  type     = trace[i];
+    uint16_t elapsed  = read_u16(&trace[i + 1]);
+    uint8_t  id       = trace[i + 3];
+    uint16_t size     = arguments_size(type);
+    if (size == UINT16_MAX || i + 4 + size > length) {
+      fprintf(stderr, "Trace is corrupt at byte %zu, stopping\n", i);
+      break;
+    }
+    const uint8_t *args = &trace[i + 4];
+    i += 4 + size;
+    session_ms += elapsed;
+
+    // Font records aren't calls: they size the stand-in for a font id before it's used
+    if (type == ConsoleTraceFont) {
+      replay_set_font(args[0], args[1], args[2]);
+      continue;
+    }
+
+    // Clear and Write records are for logs, Create and Add Pinned records make new ids, the rest are for layers
+    //   (pinned lines are layers too, and Destroy is for either)
+    Layer      *layer = layers[id];
+    ConsoleLog *log   = logs[id];
+    bool for_log = type == ConsoleTraceClear || type == ConsoleTraceWrite || type == ConsoleTraceWriteLines ||
+                   type == ConsoleTraceWritePriority || type == ConsoleTraceReservePriority ||
+                   type == ConsoleTraceSetPacked || type == ConsoleTraceExport;
+    bool known   = type == ConsoleTraceCreate || type == ConsoleTraceCreateLog || type == ConsoleTraceAddPinned || (for_log ? log != NULL : type == ConsoleTraceDestroy ? (layer || log) : layer != NULL);
+    if (!known || id == 255) {
+      skipped++;  // Created before the trace started (or there were too many layers and logs)
+      continue;
+    }
+
+    uint32_t draws_before = replay_stats.text_draws;
+    uint64_t start = now_ns();
+    switch (type) {
+      case ConsoleTraceCreate: {
+        GRect frame = GRect((int16_t)read_u16(&args[2]), (int16_t)read_u16(&args[4]), (int16_t)read_u16(&args[6]), (int16_t)read_u16(&args[8]));
+        if (read_u16(&args[0])) {
+          layers[id] = console_layer_create_with_buffer_size(frame, read_u16(&args[0]));
+          if (args[10] != 255) {
+            logs[args[10]] = console_layer_get_log(layers[id]);
+            own_log[args[10]] = true;
+          }
+        } else if (args[10] != 255 && logs[args[10]]) {
+          layers[id] = console_layer_create_with_log(frame, logs[args[10]]);
+        } else {
+          skipped++;  // Shows a log created before the trace started
+        }
+        break;
+      }
+      case ConsoleTraceCreateLog:          logs[id] = console_log_create(read_u16(&args[0])); break;
+      case ConsoleTraceSetLog:             console_layer_set_log(layer, args[0] == 255 ? NULL : logs[args[0]]); break;
+      case ConsoleTraceDestroy:
+        if (layer && pinned[id]) {
+          console_layer_remove_pinned(layer);
+          layers[id] = NULL;
+          pinned[id] = false;
+        } else if (layer) {
+          console_layer_destroy(layer);
+          layers[id] = NULL;
+        } else {
+          if (!own_log[id]) console_log_destroy(log);  // A layer's own log was destroyed with the layer
+          logs[id] = NULL;
+          own_log[id] = false;
+        }
+        break;
+      case ConsoleTraceClear:              console_log_clear(log); break;
+      case ConsoleTraceSetStyle:           console_layer_set_style(layer, (GColor){.argb = args[0]}, (GColor){.argb = args[1]}, trace_font(args[2]), args[3], args[4]); break;
+      case ConsoleTraceSetBackgroundColor: console_layer_set_background_color(layer, (GColor){.argb = args[0]}); break;
+      case ConsoleTraceSetTextColor:       console_layer_set_text_color(layer, (GColor){.argb = args[0]}); break;
+      case ConsoleTraceSetAlignment:       console_layer_set_alignment(layer, args[0]); break;
+      case ConsoleTraceSetWordWrap:        console_layer_set_word_wrap(layer, args[0]); break;
+      case ConsoleTraceSetFont:            console_layer_set_font(layer, trace_font(args[0])); break;
+      case ConsoleTraceWrite:
+      case ConsoleTraceWritePriority: {
+        uint16_t text_length = read_u16(&args[5]);
+        text[text_length] = 0;
+        console_log_write_text_priority(log, text, type == ConsoleTraceWritePriority ? ConsolePriorityHigh : ConsolePriorityNormal,
+                                        (GColor){.argb = args[0]}, (GColor){.argb = args[1]}, trace_font(args[2]), args[3], args[4]);
+        text[text_length] = 'x';
+        break;
+      }
+      case ConsoleTraceReservePriority:    console_log_reserve_priority(log, read_u16(&args[0])); break;
+      case ConsoleTraceAddPinned:
+        if (args[0] != 255 && layers[args[0]] && !pinned[args[0]]) {
+          layers[id] = console_layer_add_pinned(layers[args[0]], args[1], read_u16(&args[2]));
+          pinned[id] = true;
+        } else {
+          skipped++;  // Pinned to a layer created before the trace started
+        }
+        break;
+      case ConsoleTraceUpdatePinned: {
+        uint16_t text_length = read_u16(&args[0]);
+        text[text_length] = 0;
+        console_layer_update_pinned(layer, text);
+        text[text_length] = 'x';
+        break;
+      }
+      case ConsoleTraceSetPacked:          console_log_set_packed(log, args[0]); break;
+      case ConsoleTraceExport:
+        // The whole export is counted, with every batch acknowledged as soon as it's sent
+        #if (console_layer_phone_export)
+        console_log_export(log);
+        while (replay_outbox())
+          replay_outbox_finish(APP_MSG_OK);
+        #endif
+        break;
+      case ConsoleTraceWriteLines: {
+        // Only the total length is recorded, so the lines are replayed as equally long (split from one string)
+        uint16_t line_count = read_u16(&args[5]), text_length = read_u16(&args[7]);
+        size_t at = 0;
+        for (uint16_t line = 0; line < line_count; line++) {
+          uint16_t line_length = text_length / line_count + (line < text_length % line_count);
+          memset(&lines[at], 'x', line_length);
+          at += line_length;
+          lines[at++] = '\n';
+        }
+        lines[at] = 0;
+        start = now_ns();  // Don't count making up the lines
+        if (line_count)
+          console_log_write_split(log, lines, (GColor){.argb = args[0]}, (GColor){.argb = args[1]}, trace_font(args[2]), args[3], args[4]);
+        break;
+      }
+      case ConsoleTraceRedraw:
+        replay_layer_draw(layer);
+        redraws++;
+        device_redraw_ms += read_u16(&args[0]);
+        if (read_u16(&args[0]) > device_redraw_max_ms) device_redraw_max_ms = read_u16(&args[0]);
+        device_rows += args[2];
+        replay_rows += replay_stats.text_draws - draws_before;
+        break;
+    }
+    uint64_t spent = now_ns() - start;
+    costs[type].count++;
+    costs[type].total_ns += spent;
+    if (spent > costs[type].max_ns) costs[type].max_ns = spent;
+  }
+
+  // Report
+  printf("Trace: %zu bytes, %.1f seconds on the watch\n\n", length, session_ms / 1000.0);
+  printf("%-22s %8s %12s %10s %10s\n", "Operation", "Count", "Total (us)", "Avg (ns)", "Max (ns)");
+  for (size_t type = 0; type < TYPE_COUNT; type++)
+    if (costs[type].count)
+      printf("%-22s %8u %12.1f %10llu %10llu\n", type_names[type], costs[type].count, costs[type].total_ns / 1000.0,
+             (unsigned long long)(costs[type].total_ns / costs[type].count), (unsigned long long)costs[type].max_ns);
+  printf("\n");
+  printf("Redraws:        %u", redraws);
+  if (redraws)
+    printf(" (watch: %.1f ms avg, %llu ms max, %.1f rows avg; replay: %.1f rows avg)",
+           (double)device_redraw_ms / redraws, (unsigned long long)device_redraw_max_ms, (double)device_rows / redraws, (double)replay_rows / redraws);
+  printf("\n");
+  printf("Text measures:  %u\n", replay_stats.text_measures);
+  printf("Text draws:     %u\n", replay_stats.text_draws);
+  printf("Fills:          %u\n", replay_stats.fills);
+  printf("Dirty marks:    %u\n", replay_stats.dirty_marks);
+  if (replay_stats.frame_buffer_captures)
+    printf("Glyph draws:    %u (frame buffer captures)\n", replay_stats.frame_buffer_captures);
+  printf("Peak heap:      %zu bytes\n", replay_stats.heap_peak);
+  if (replay_stats.messages_sent)
+    printf("Export batches: %u (%u bytes)\n", replay_stats.messages_sent, replay_stats.message_bytes);
+  if (skipped)
+    printf("Skipped:        %u records for layers and logs not created in the trace\n", skipped);
+
+  for (size_t id = 0; id < MAX_IDS; id++)
+    if (layers[id] && !pinned[id]) console_layer_destroy(layers[id]);  // Along with its pinned lines
+  for (size_t id = 0; id < MAX_IDS; id++)
+    if (logs[id] && !own_log[id]) console_log_destroy(logs[id]);
+  free(lines);
+  free(text);
+  free(trace);
+  return 0;
+}